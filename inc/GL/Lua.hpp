@@ -75,7 +75,7 @@ inline void lua_setup_GL(sol::state& lua)
     texture["setUpdateCallback"] = &Texture::setUpdateCallback;
     texture["type"] = sol::property(&Texture::getType, &Texture::setType);
     texture["loadImage"] = &Texture::loadImage;
-    texture["edit"] = &Texture::editRawPixels;
+    texture["edit"] = sol::resolve<void(void const*, int, int)>(&Texture::editRawPixels);
     texture["setColor"] = &Texture::setColor;
     texture["text_area"] = sol::property(&Texture::getTextArea, &Texture::setTextArea);
     texture["getDimensions"] = sol::resolve<std::tuple<int, int>() const>(&Texture::getCurrentDimensions);
@@ -151,6 +151,11 @@ inline void lua_setup_GL(sol::state& lua)
         { "Full", Plane::Hitbox::Full }
     });
 
+    gl.new_enum<Window::PickingMode>("PickingMode", {
+        { "CPU", Window::PickingMode::CPU },
+        { "GPU", Window::PickingMode::GPU }
+    });
+
     auto window = gl.new_usertype<Window>("Window", sol::factories(&Window::create),
         sol::base_classes, sol::bases<Base>());
     window["blockInputs"] = &Window::blockInputs;
@@ -206,6 +211,7 @@ inline void lua_setup_GL(sol::state& lua)
 
     window["fps_limit"] = sol::property(&Window::getFPSLimit, &Window::setFPSLimit);
     window["vsync"] = sol::property(&Window::getVSYNC, &Window::setVSYNC);
+    window["picking_mode"] = sol::property(&Window::getPickingMode, &Window::setPickingMode);
     window["title"] = sol::property(&Window::getTitle, &Window::setTitle);
     window["setDimensions"] = &Window::setDimensions;
     window["getDimensions"] = sol::resolve<std::tuple<int, int>() const>(&Window::getDimensions);
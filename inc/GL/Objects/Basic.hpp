@@ -17,6 +17,14 @@
 #include <GLFW/glfw3.h>
 #include <map>
 
+// S3TC formats are only defined when glad was generated with the extension
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
 /** @file
  *  Defines namespace SSS::GL::Basic and subsequent classes.
  */
@@ -147,14 +155,59 @@ namespace Basic {
          */
         void parameteri(GLenum pname, GLint param);
 
-        bool editSettings(int width, int height, int depth = 1);
+        /** Reallocates storage if any setting changed, returns true if so.
+         *  Compressed internal formats (BC1, BC3, BC7, ETC2) expect their
+         *  data to be uploaded via editCompressedPixels(), single-channel
+         *  ones (\c GL_R8, \c GL_R32F) tightly packed texels.
+         */
+        bool editSettings(int width, int height, int depth = 1,
+            GLenum internal_format = GL_RGBA8);
         /** Edits pixel storage.
          *  Effectively calls \c glTexImage2D() with #target and
          *  given arguments.
          * 
+         *  Pixels are expected in the layout given by texelFormat().
+         *
          *  Implicitly calls bind().
          */
         void editPixels(const GLvoid* pixels, int z_offset = 0);
+        /** Edits compressed pixel storage with blocks matching the
+         *  internal format given to editSettings().
+         *  Effectively calls \c glCompressedTexSubImage3D() with #target
+         *  and given arguments.
+         *
+         *  Implicitly calls bind().
+         */
+        void editCompressedPixels(const GLvoid* blocks, GLsizei size, int z_offset = 0);
+        /** Returns the internal format set via editSettings().*/
+        inline GLenum getInternalFormat() const noexcept { return _internal_format; };
+
+        /** Frees the GPU storage while keeping current settings.
+         *  Storage is reallocated (empty) by the next editSettings() call,
+         *  even if settings didn't change.
+         */
+        void release();
+        /** Whether the storage was freed via release().*/
+        inline bool isReleased() const noexcept { return _released; };
+        /** Returns the byte size of the currently allocated storage.*/
+        inline size_t getByteSize() const noexcept { return _byte_size; };
+        /** Returns the byte size of the storage freed via release(),
+         *  or 0 if the storage is allocated.
+         */
+        inline size_t getReleasedByteSize() const noexcept { return _released_bytes; };
+        /** Returns the byte size of every allocated Basic::Texture storage.*/
+        static inline size_t getAllocatedBytes() noexcept { return _allocated_bytes; };
+
+        /** Returns the byte size of a single width x height image in
+         *  given compressed format, or 0 if the format isn't compressed.
+         */
+        static GLsizei compressedSize(GLenum format, int width, int height) noexcept;
+        /** Retrieves the pixel format & type expected by editPixels() for
+         *  given uncompressed internal format, and returns the byte size of
+         *  a single texel. Anything else than \c GL_R8 and \c GL_R32F is
+         *  uploaded as \c GL_RGBA bytes.
+         */
+        static GLsizei texelFormat(GLenum internal_format, GLenum& format, GLenum& type) noexcept;
 
         /** %Texture ID generated by \b OpenGL.*/
         GLuint id;
@@ -163,6 +216,16 @@ namespace Basic {
         /** The target specified in the constructor.*/
         GLenum _target;
         int _width{ 0 }, _height{ 0 }, _depth{ 0 };
+        GLenum _internal_format{ GL_RGBA8 };
+        bool _released{ false };
+        size_t _byte_size{ 0 };
+        size_t _released_bytes{ 0 };   // _byte_size before release()
+
+        // Sum of every instance's _byte_size
+        static size_t _allocated_bytes;
+
+        // (Re)allocates storage based on current settings
+        void _allocate();
     };
 
     /** Abstractisation of OpenGL vertex buffer objects (\b %VBO) and
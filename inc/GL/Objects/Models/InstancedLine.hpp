@@ -0,0 +1,92 @@
+#ifndef SSS_GL_INSTANCED_LINE_HPP
+#define SSS_GL_INSTANCED_LINE_HPP
+
+#include "Line.hpp"
+
+/** @file
+ *  Defines class SSS::GL::InstancedLine.
+ */
+
+SSS_GL_BEGIN;
+
+// Ignore warning about STL exports as they're private members
+#pragma warning(push, 2)
+#pragma warning(disable: 4251)
+#pragma warning(disable: 4275)
+
+/** Polyline alternative meshed by the GPU.
+ *
+ *  Only path points are uploaded: InstancedLineRenderer expands each
+ *  segment into a quad in its vertex shader, and computes joints, caps
+ *  and anti-aliasing analytically in its fragment shader. Suited to lines
+ *  with a lot of points, or edited every frame.
+ *  @sa InstancedLine::create()
+ */
+class SSS_GL_API InstancedLine {
+    friend class InstancedLineRenderer;
+
+public:
+    /** Same joints as Polyline.*/
+    using JointType = Polyline::JointType;
+    /** Same terminaisons as Polyline.*/
+    using TermType = Polyline::TermType;
+
+    /** Path point, laid out as read by the shader (std430).*/
+    struct Point {
+        Point(glm::vec3 pos = glm::vec3(0.f), float thick = 10.f,
+            glm::vec4 col = glm::vec4(0, 0, 0, 1))
+            : position(pos), thickness(thick), color(col) {};
+
+        glm::vec3 position;
+        /** Full width of the line at this point.*/
+        float thickness;
+        glm::vec4 color;
+
+        using Vec = std::vector<Point>;
+    };
+
+private:
+    InstancedLine(Point::Vec points, JointType jopt, TermType topt);
+public:
+    ~InstancedLine();
+
+    using Shared = std::shared_ptr<InstancedLine>;
+
+    /** Creates a line from points holding their own thickness & color.*/
+    static Shared create(Point::Vec points,
+        JointType jopt = JointType::BEVEL, TermType topt = TermType::BUTT);
+
+    /** Creates a line from a Polyline path, evaluating gradients once per point.*/
+    static Shared create(Polyline::Vertex::Vec const& path,
+        Math::Gradient<float> thickness, Math::Gradient<glm::vec4> color,
+        JointType jopt = JointType::BEVEL, TermType topt = TermType::BUTT);
+
+    static Shared create(Polyline::Vertex::Vec const& path,
+        float thickness = 10.0f, glm::vec4 color = glm::vec4(0, 0, 0, 1),
+        JointType jopt = JointType::BEVEL, TermType topt = TermType::BUTT);
+
+    /** Replaces every point, which are uploaded on the next render.*/
+    void setPoints(Point::Vec points);
+    inline Point::Vec const& getPoints() const noexcept { return _points; };
+
+    void setJointType(JointType jopt);
+    inline JointType getJointType() const noexcept { return _jopt; };
+
+    void setTermType(TermType topt);
+    inline TermType getTermType() const noexcept { return _topt; };
+
+private:
+    static std::vector<std::weak_ptr<InstancedLine>> _batch;
+    // Incremented whenever a line is created, edited or destroyed
+    static uint64_t _batch_version;
+
+    Point::Vec _points;
+    JointType _jopt;
+    TermType _topt;
+};
+
+#pragma warning(pop)
+
+SSS_GL_END;
+
+#endif // SSS_GL_INSTANCED_LINE_HPP
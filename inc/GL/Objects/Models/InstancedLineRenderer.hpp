@@ -0,0 +1,60 @@
+#ifndef SSS_GL_INSTANCED_LINE_RENDERER_HPP
+#define SSS_GL_INSTANCED_LINE_RENDERER_HPP
+
+#include "InstancedLine.hpp"
+#include "../Renderer.hpp"
+#include "../Camera.hpp"
+
+/** @file
+ *  Defines class SSS::GL::InstancedLineRenderer.
+ */
+
+SSS_GL_BEGIN;
+
+// Ignore warning about STL exports as they're private members
+#pragma warning(push, 2)
+#pragma warning(disable: 4251)
+#pragma warning(disable: 4275)
+
+/** Renders every InstancedLine, one instanced quad per segment.
+ *  Points are bound as a shader storage buffer, segments only hold
+ *  point indices and styles.
+ */
+class SSS_GL_API InstancedLineRenderer : public Renderer<InstancedLineRenderer> {
+    friend class SharedClass;
+
+private:
+    InstancedLineRenderer();
+
+public:
+    Camera::Shared camera;
+    virtual void render() override;
+
+private:
+    // Per instance attributes
+    struct _Segment {
+        // Previous, first, second & next point indices.
+        // Previous & next are the segment's own when absent.
+        glm::uvec4 points;
+        // joint | term << 2 | has_previous << 4 | has_next << 5
+        uint32_t style;
+    };
+
+    Basic::VAO _vao;
+    // Points of every line, bound as SSBO 0
+    Basic::VBO _points;
+    // One instance per segment: point indices & style
+    Basic::VBO _segments;
+    GLsizei _segment_count{ 0 };
+    // InstancedLine::_batch_version when last rebuilt
+    uint64_t _batch_version{ 0 };
+
+    // Gathers points & segments of every line
+    void _rebuild();
+};
+
+#pragma warning(pop)
+
+SSS_GL_END;
+
+#endif // SSS_GL_INSTANCED_LINE_RENDERER_HPP
@@ -4,6 +4,9 @@
 #include <SSS/Math.hpp>
 #include "../Basic.hpp"
 #include <unordered_map>
+#include <functional>
+#include <future>
+#include <optional>
 
 SSS_GL_BEGIN;
 
@@ -14,6 +17,7 @@ SSS_GL_BEGIN;
 
 class SSS_GL_API Polyline {
     friend class LineRenderer;
+    friend SSS_GL_API void pollEverything();
 
 public:
     enum struct JointType {
@@ -53,10 +57,21 @@ public:
         }
     };
 
+    /** Parameters of a line created by Batch() or BatchAsync().*/
+    struct Params {
+        Vertex::Vec path;
+        Math::Gradient<float> thickness;
+        Math::Gradient<glm::vec4> color;
+        JointType jopt{ JointType::BEVEL };
+        TermType topt{ TermType::BUTT };
+    };
+
 private:
     Polyline(Vertex::Vec path,
         Math::Gradient<float> thickness, Math::Gradient<glm::vec4> color, 
         JointType jopt, TermType topt);
+    // Meshes without stamping nor batching, safe on worker threads
+    Polyline(Params&& params);
 public:
     ~Polyline();
 
@@ -90,10 +105,54 @@ public:
         float thickness = 10.0f, glm::vec4 color = glm::vec4(0,0,0,1),
         JointType jopt = JointType::BEVEL, TermType topt = TermType::BUTT);
 
+    /** Creates lines meshed concurrently on worker threads, which are
+     *  then added to the LineRenderer batch at once.
+     *  Returned lines are in the same order as given parameters.
+     *  Must be called from the GL thread.
+     *  @sa BatchAsync()
+     */
+    static std::vector<Shared> Batch(std::vector<Params> params);
+    /** Same as Batch(), without waiting for the meshing.
+     *  A later pollEverything() call adds the lines to the LineRenderer
+     *  batch at once, and gives them to the optional callback.
+     */
+    static void BatchAsync(std::vector<Params> params,
+        std::function<void(std::vector<Shared> const&)> callback = nullptr);
+    /** Whether lines given to BatchAsync() are still being meshed.*/
+    static inline bool isBatchPending() noexcept { return !_pending_batches.empty(); };
+
+    /** Sets the maximum distance, in pixels, between Bezier lines and
+     *  their flattened paths. Defaults to 0.25 pixel.
+     *  Bezier lines are flattened again for the zoom of the camera
+     *  last used by a LineRenderer, whenever it changes their segment count.
+     */
+    static void setBezierTolerance(float pixels) noexcept;
+    static inline float getBezierTolerance() noexcept { return bezier_tolerance; };
+
+    /** Appends the flattened cubic Bezier curve to given path, in order.
+     *  The segment count is given by Wang's formula for the tolerance,
+     *  in path units, and points are computed by forward differencing.
+     *  Reusing the same path avoids any allocation.
+     */
+    static void flattenBezier(glm::vec3 a, glm::vec3 b, glm::vec3 c, glm::vec3 d,
+        float tolerance, Vertex::Vec& path);
+
     static inline void setMaxDepth(uint32_t depth) noexcept { max_depth = depth; };
     static inline uint32_t getMaxDepth() noexcept { return max_depth; };
 
     uint32_t update(Math::Gradient<float> gradient_thickness, Math::Gradient<glm::vec4> gradient_color);
+    /** Appends points to the path, only meshing the new segments
+     *  instead of the whole line.
+     *  Already meshed points keep the thickness & color the gradients
+     *  gave them, call update() to spread gradients over the whole path.
+     *  Lines with TermType::CONNECT are entirely remeshed.
+     */
+    void appendPoints(Vertex::Vec const& points);
+
+    /** Returns the vertex count of the current mesh.*/
+    inline size_t getVertexCount() const noexcept { return mesh.size(); };
+    /** Returns the triangle count of the current mesh.*/
+    inline size_t getTriangleCount() const noexcept { return indices.size(); };
 
     static bool sort(std::weak_ptr<Polyline>& f, std::weak_ptr<Polyline>& s)
     {
@@ -106,21 +165,60 @@ public:
 private:
 
     static std::vector<std::weak_ptr<Polyline>> _batch;
-    // State of the batch, information about when the buffer has been
-    // modified and should be regenerated
-    static bool modified;
+    // State of the batch, incremented whenever a line is created, remeshed
+    // or destroyed, so that renderers only walk the batch on changes
+    static uint64_t batch_version;
     static uint32_t max_depth;
+    static float bezier_tolerance;
+    // Camera zoom Bezier lines are flattened for
+    static float bezier_scale;
+    // Highest camera zoom rendered since Bezier lines were last flattened
+    static float bezier_frame_scale;
+    // Whether the tolerance changed since lines were last flattened
+    static bool bezier_dirty;
+
+    // Control points of lines created by Bezier()
+    struct _Bezier {
+        glm::vec3 a, b, c, d;
+        uint32_t segments;
+    };
+    std::optional<_Bezier> _bezier;
+
+    static uint32_t _bezierSegments(glm::vec3 a, glm::vec3 b, glm::vec3 c, glm::vec3 d,
+        float tolerance) noexcept;
+    static void _flattenBezier(glm::vec3 a, glm::vec3 b, glm::vec3 c, glm::vec3 d,
+        uint32_t segments, Vertex::Vec& path);
+    // Flattens Bezier lines again if the highest zoom rendered last frame
+    // changes their segment count, called once per frame by pollEverything()
+    static void _flattenBeziers();
+
+    struct _PendingBatch {
+        std::future<std::vector<Shared>> lines;
+        std::function<void(std::vector<Shared> const&)> callback;
+    };
+    // Lines meshed by BatchAsync(), published by pollEverything()
+    static std::vector<_PendingBatch> _pending_batches;
+
+    // Meshes given lines concurrently, on any thread
+    static std::vector<Shared> _meshBatch(std::vector<Params>&& params);
+    // Meshes given path in place, reusing buffers, for LineRenderer::drawTransient()
+    void _meshTransient(Vertex::Vec const& new_path,
+        Math::Gradient<float> const& thickness, Math::Gradient<glm::vec4> const& color,
+        JointType jopt, TermType topt);
+    // Stamps meshes & adds lines to the batch, on the GL thread
+    static void _publish(std::vector<Shared> const& lines);
+    static void _pollBatches();
 
     struct Mesh_info {
         Mesh_info();
-        Mesh_info(uint16_t t, uint16_t b, uint16_t aat, uint16_t aab);
+        Mesh_info(uint32_t t, uint32_t b, uint32_t aat, uint32_t aab);
 
-        void update(uint16_t t, uint16_t b, uint16_t aat, uint16_t aab);
-        uint16_t top, btm, aa_top, aa_btm;
+        void update(uint32_t t, uint32_t b, uint32_t aat, uint32_t aab);
+        uint32_t top, btm, aa_top, aa_btm;
     };
 
     struct Indices {
-        Indices(uint16_t uc = 0, uint16_t bc = 0, uint16_t sc = 0)
+        Indices(uint32_t uc = 0, uint32_t bc = 0, uint32_t sc = 0)
             : _uc(uc), _bc(bc), _sc(sc) {};
 
         uint32_t _uc, _bc, _sc;
@@ -143,13 +241,29 @@ private:
     Vertex::Vec path;
     Vertex::Vec mesh;
     Indices::Vec indices;
+    // Unique stamp of the current mesh, renderers only upload changed ones
+    uint64_t mesh_version{ 0 };
+    // Axis-aligned bounds of the mesh, computed by path_meshing()
+    glm::vec3 _bounds_min{ 0 }, _bounds_max{ 0 };
+
+    // Meshing state before the last terminaison, resumed by appendPoints()
+    struct _Tail {
+        size_t mesh_size{ 0 };
+        size_t indices_size{ 0 };
+        Mesh_info last;
+        glm::vec3 ortho{ 0 };
+    };
+    _Tail _tail;
+    // Points added to the path by connect_ending()
+    uint32_t _closing_points{ 0 };
 
     float define_line_thickness(float thickness);
     float define_aa_thickness(float thickness);
     uint8_t quad_index(uint32_t lft_top, uint32_t lft_btm, uint32_t rgt_btm, uint32_t rgt_top);
 
-    //Create the mesh of the line using the path data
-    uint8_t path_meshing(Math::Gradient<float> gradient_thickness, Math::Gradient<glm::vec4> gradient_color, JointType jopt, TermType topt);
+    //Create the mesh of the line using the path data, from the given point.
+    //Meshing resumes from _tail when first isn't 0.
+    uint8_t path_meshing(Math::Gradient<float> gradient_thickness, Math::Gradient<glm::vec4> gradient_color, JointType jopt, TermType topt, size_t first = 0);
 
 
     //terminaisons functions
@@ -22,12 +22,114 @@ public:
     Camera::Shared camera;
     virtual void render() override;
 
+    /** Draws a line during the next render() call only.
+     *  The line is meshed right away into a per-frame arena, which
+     *  render() streams to the GPU after retained lines, then discards.
+     *  Transient lines never touch the Polyline batch.
+     */
+    void drawTransient(Polyline::Vertex::Vec const& path,
+        Math::Gradient<float> const& thickness, Math::Gradient<glm::vec4> const& color,
+        Polyline::JointType jopt = Polyline::JointType::BEVEL,
+        Polyline::TermType topt = Polyline::TermType::BUTT);
+
+    void drawTransient(Polyline::Vertex::Vec const& path,
+        float thickness = 10.0f, glm::vec4 color = glm::vec4(0, 0, 0, 1),
+        Polyline::JointType jopt = Polyline::JointType::BEVEL,
+        Polyline::TermType topt = Polyline::TermType::BUTT);
+
+    /** Sets whether retained lines are drawn back to front, by depth of
+     *  their bounds' center, for translucent lines to blend correctly.
+     *  Disabled by default, lines are then drawn in batch order.
+     *  Lines outside of the camera's view are culled either way.
+     */
+    inline void setDepthSorting(bool state) noexcept { _depth_sorting = state; };
+    inline bool getDepthSorting() const noexcept { return _depth_sorting; };
+
+    /** Vertex formats of retained lines in GPU memory.
+     *  @sa setVertexFormat()
+     */
+    enum class VertexFormat {
+        /** 28 bytes per vertex: float position & color, as meshed.*/
+        Full,
+        /** 12 bytes per vertex: float xy position & RGBA8 color.
+         *  Lines being flat, their z is stored once per line.
+         */
+        Packed
+    };
+    /** Sets the vertex format of retained lines, which are then all
+     *  uploaded again. Transient lines always use VertexFormat::Full.
+     */
+    void setVertexFormat(VertexFormat format);
+    inline VertexFormat getVertexFormat() const noexcept { return _vertex_format; };
+
 private:
     Basic::VAO _vao;
     Basic::VBO _vbo;
     Basic::IBO _ibo;
 
-    void gen_batch(Polyline::Vertex::Vec& mesh, Polyline::Indices::Vec& indices);
+    // Transient lines, streamed & discarded by each render() call
+    Basic::VAO _transient_vao;
+    Basic::VBO _transient_vbo;
+    Basic::IBO _transient_ibo;
+    // Per-frame arena, cleared without releasing its capacity
+    Polyline::Vertex::Vec _transient_vertices;
+    Polyline::Indices::Vec _transient_indices;
+    // Meshes transient lines, reusing its own buffers
+    std::unique_ptr<Polyline> _transient_line;
+
+    // Range of a line in the shared buffers, indices are local to the line
+    struct _Slot {
+        std::weak_ptr<Polyline> line;
+        Polyline const* ptr{ nullptr };
+        uint64_t version{ 0 };      // Polyline::mesh_version when uploaded
+        uint32_t first_vertex{ 0 }, vertex_count{ 0 }, vertex_capacity{ 0 };
+        uint32_t first_index{ 0 }, index_count{ 0 }, index_capacity{ 0 };
+        glm::vec3 bounds_min{ 0 }, bounds_max{ 0 };
+    };
+    std::vector<_Slot> _slots;          // Live lines, in batch order
+    uint64_t _batch_version{ 0 };       // Polyline::batch_version when last synced
+    uint32_t _vertex_end{ 0 };          // End of allocated vertices
+    uint32_t _index_end{ 0 };           // End of allocated indices (triangles)
+    uint32_t _vertex_capacity{ 0 };     // Vertex buffer size
+    uint32_t _index_capacity{ 0 };      // Index buffer size (triangles)
+    VertexFormat _vertex_format{ VertexFormat::Full };
+    struct _PackedVertex {
+        glm::vec2 position;
+        uint32_t color;     // RGBA8
+    };
+    // Meshes are converted here before being uploaded as packed vertices
+    std::vector<_PackedVertex> _packed;
+    // VertexFormat::Packed draws, one command & one z per visible line.
+    // The z is an instanced attribute, fetched through each base instance.
+    struct _DrawCommand {
+        GLuint count, instance_count, first_index;
+        GLint base_vertex;
+        GLuint base_instance;
+    };
+    std::vector<_DrawCommand> _commands;
+    std::vector<float> _lines_z;
+    Basic::VBO _commands_buffer;        // Bound as GL_DRAW_INDIRECT_BUFFER
+    Basic::VBO _lines_z_vbo;
+
+    bool _depth_sorting{ false };
+    // Visible slots with their depth, reused every frame
+    std::vector<std::pair<float, _Slot const*>> _visible;
+    // glMultiDrawElementsBaseVertex arguments, one per visible slot
+    std::vector<GLsizei> _counts;
+    std::vector<void const*> _offsets;
+    std::vector<GLint> _base_vertices;
+
+    // Matches slots with the batch, writing new & changed lines only
+    void _syncBatch();
+    // Repacks every live line, growing buffers if needed
+    void _compact();
+    // Writes a line's mesh at its slot
+    void _write(_Slot const& slot, Polyline const& line);
+    // Sets up attributes of retained lines for the current vertex format
+    void _setupVAO();
+    size_t _vertexSize() const noexcept;
+    // Culls slots against given matrix, sorting them if needed
+    void _buildDrawList(glm::mat4 const& vp);
 };
 
 #pragma warning(pop)
@@ -27,6 +27,9 @@ class SSS_GL_API PlaneBase : public Observer, public ModelBase, public _EventReg
 
 private:
     static std::set<std::reference_wrapper<PlaneBase>> _instances;
+    // Dense list of playing planes, ticked by pollEverything().
+    // Holds nullptr for destroyed planes and paused ones until the next tick.
+    static std::vector<PlaneBase*> _playing;
     bool hidden = false;
 
 protected:
@@ -60,17 +63,41 @@ public:
 
     inline void setAnimationFrame(const int i) noexcept { _setTextureOffset(i % _texture->getFrames().size()); };
 
-    inline void play() noexcept { _is_playing = true; };
-    inline void pause() noexcept { _is_playing = false; };
-    inline void stop() noexcept { _is_playing = false; _animation_duration = std::chrono::nanoseconds(0); };
+    void play();
+    void pause();
+    void stop();
 
     inline bool isPlaying() const noexcept { return _is_playing; };
     inline bool isPaused() const noexcept { return !_is_playing && _animation_duration != std::chrono::nanoseconds(0); };
     inline bool isStopped() const noexcept { return !_is_playing && _animation_duration == std::chrono::nanoseconds(0); };
 
-    void setLooping(bool enable) noexcept { _looping = enable; };
+    void setLooping(bool enable);
     bool isLooping() const noexcept { return _looping; };
 
+    /** Where animations are advanced.*/
+    enum class AnimationMode {
+        /** Advanced by pollEverything(), which emits an event on each
+         *  frame change (default).
+         */
+        CPU,
+        /** Computed by the PlaneRenderer vertex shader from a global clock
+         *  and the frame delays of the Texture, without any CPU cost once
+         *  playing. Non-looping animations go back to their first frame
+         *  once completed, like on the CPU, but isPlaying() stays true
+         *  until pause() or stop() is called.
+         *  Textures remapping their layers while playing (StreamedTexture,
+         *  TiledNoise) are better animated on the CPU.
+         */
+        GPU
+    };
+    /** Sets where animations are advanced, keeping the current position.*/
+    void setAnimationMode(AnimationMode mode);
+    inline AnimationMode getAnimationMode() const noexcept { return _animation_mode; };
+
+    /** Sets the playback speed multiplier (default: 1, negative values are clamped to 0).*/
+    void setAnimationSpeed(float speed);
+    inline float getAnimationSpeed() const noexcept { return _animation_speed; };
+
     void setAlpha(float alpha) noexcept;
     inline float getAlpha(void) const noexcept { return _alpha; };
 
@@ -95,7 +122,13 @@ public:
     /** Returns relative hovering coordinates (only valid if isHovered() returns true).*/
     inline void getRelativeCoords(int& x, int& y) const noexcept { x = _relative_x; y = _relative_y; };
 
-    inline uint32_t getTexOffset() const noexcept { return _texture_offset; };
+    /** Returns the Texture layer of the current animation frame.
+     *  Identical frames share a single layer, so this may differ from
+     *  the frame index.
+     */
+    inline uint32_t getTexOffset() const noexcept {
+        return _texture ? _texture->getFrames().layerOf(_texture_offset) : _texture_offset;
+    };
 
     /** SDF rendering mode for this plane (see PlaneRenderer).*/
     enum class SDFMode { None, Shape, Mask };
@@ -104,9 +137,25 @@ public:
     /** None: textured quad (default); Shape: SDF-only; Mask: SDF as alpha mask over texture.*/
     SDFMode sdf_mode{ SDFMode::None };
 
+protected:
+    // Registers a raw copy (see duplicate()) in the playing list
+    void _relinkPlaying();
+
 private:
     void _setTextureOffset(uint32_t offset);
-    void _updateTextureOffset();
+    // Advances the animation and computes the next frame, without emitting
+    // any event, so that planes can be advanced in parallel
+    void _advanceAnimation(std::chrono::nanoseconds elapsed) noexcept;
+    // Advances every playing plane, then applies their frames
+    static void _tickAnimations(std::chrono::nanoseconds elapsed);
+    // Milliseconds elapsed since the first call, shared with the plane shader
+    static uint32_t _gpuClock() noexcept;
+    // Catches up a playing GPU animation on the CPU timeline, updating its frame
+    void _syncGPUAnimation();
+    // Per-instance data of the GPU animation mode, see PlaneRenderer
+    glm::uvec4 _getGPUAnimation(uint32_t table_offset) const noexcept;
+    // Frame currently displayed, computed like the plane shader in GPU mode
+    uint32_t _displayedFrame() const noexcept;
 
     Texture::Shared _texture;
     std::function<void(PlaneBase&)> _texture_callback;
@@ -115,6 +164,12 @@ private:
     bool _is_playing{ false };
     bool _looping{ false };
     std::chrono::nanoseconds _animation_duration{ 0 };
+    size_t _playing_index{ SIZE_MAX };  // Position in _playing, SIZE_MAX if absent
+    uint32_t _next_offset{ 0 };         // Frame computed by _advanceAnimation()
+    bool _advanced{ false };            // Whether _next_offset is yet to be applied
+    AnimationMode _animation_mode{ AnimationMode::CPU };
+    float _animation_speed{ 1.f };
+    uint32_t _gpu_start{ 0 };           // _gpuClock() when the GPU animation resumed
     float _alpha{ 1.f };
     GLsizei _tex_w{ 0 }, _tex_h{ 0 };
     glm::vec3 _tex_scaling{ 1 };
@@ -156,6 +211,7 @@ public:
     {
         auto shared = create();
         std::memcpy(shared.get(), this, sizeof(Derived));
+        shared->_relinkPlaying();
         return shared;
     }
 };
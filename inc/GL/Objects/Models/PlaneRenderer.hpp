@@ -4,6 +4,8 @@
 #include "Plane.hpp"
 #include "../Renderer.hpp"
 #include "../Camera.hpp"
+#include <unordered_map>
+#include <unordered_set>
 
 /** @file
  *  Defines internal class behind SSS::GL::Plane::Renderer alias.
@@ -34,6 +36,12 @@ protected:
 
     template <typename C, typename T>
     void _updateVBO(T(C::* getMember)() const, Basic::VBO& vbo);
+    // Updates GPU animation instance data & the frame timings table
+    void _updateAnimationVBO();
+    // Updates every dynamic VBO which needs it
+    void _updateVBOs();
+    // Binds textures of instanced planes and draws them with given shader
+    void _drawInstances(Shaders& shader) const;
 
 public:
     virtual void render() override;
@@ -70,6 +78,7 @@ public:
             if (plane)
                 _observe(*plane);
         _update_vbos = true;
+        _grid_dirty = true;
     }
     
     template <std::derived_from<PlaneBase> _Plane>
@@ -91,6 +100,7 @@ public:
         for (auto const& plane : planes)
             _ignore(*plane);
         _update_vbos = true;
+        _grid_dirty = true;
     }
 
     using SharedClass::create;
@@ -147,6 +157,10 @@ protected:
     Basic::VBO _alpha_vbo;
     // Plane texture offset (used to read apng)
     Basic::VBO _tex_offset_vbo;
+    // Plane GPU animation (see PlaneBase::AnimationMode::GPU)
+    Basic::VBO _animation_vbo;
+    // Frame timings of GPU animated textures, bound as SSBO 1
+    Basic::VBO _animation_table;
 
     // To update all dynamic vbos
     bool _update_vbos{ true };
@@ -155,10 +169,41 @@ protected:
     GLuint _sdf_ssbo{ 0 };
     // Non-instanced quad VAO used to draw SDF planes (model/alpha passed as uniforms)
     Basic::VAO _sdf_plane_vao;
+    // Plane picking ID | hitbox << 30, only bound by the picking pass
+    Basic::VBO _pick_vbo;
 
     std::weak_ptr<PlaneBase> _hovered;
     double _hovered_z{ DBL_MAX };
     bool _findNearestModel(double x, double y);
+    // Draws hitboxes in the bound picking framebuffer (see Window::PickingMode::GPU).
+    // Drawn planes are appended to given vector, their picking ID being their index + 1.
+    void _renderPicking(std::vector<std::weak_ptr<PlaneBase>>& targets);
+
+    // Uniform grid of world space XY bounds of planes, so that hover
+    // picking only tests planes under the cursor ray.
+    // Cells hold indices in _planes, keyed by packed cell coordinates.
+    std::unordered_map<uint64_t, std::vector<uint32_t>> _grid;
+    // Cells covered by each plane (min x, min y, max x, max y), like _planes
+    std::vector<glm::ivec4> _grid_ranges;
+    // Planes covering too many cells, always tested
+    std::vector<uint32_t> _grid_large;
+    // Indices in _planes, to find moved planes
+    std::unordered_map<Subject const*, uint32_t> _grid_ids;
+    // Planes moved since last picking, re-inserted lazily
+    std::unordered_set<Subject const*> _grid_moved;
+    float _grid_cell_size{ 1.f };
+    // Z range of the bounds of each plane, like _planes
+    std::vector<glm::vec2> _grid_depths;
+    // Z range of every bound, clipping picking rays
+    float _grid_z_min{ 0.f }, _grid_z_max{ 0.f };
+    // Whether a plane on the z range's bounds moved since last picking
+    bool _grid_z_stale{ false };
+    // Whether planes were added or removed since the last rebuild
+    bool _grid_dirty{ true };
+
+    void _rebuildGrid();
+    void _gridInsert(uint32_t id);
+    void _gridRemove(uint32_t id);
 };
 
 #pragma warning(pop)
@@ -2,6 +2,7 @@
 #define SSS_GL_NOISE_HPP
 
 #include "Texture.hpp"
+#include <unordered_map>
 
 /** @file
  *  Defines class SSS::GL::Noise.
@@ -16,10 +17,14 @@ SSS_GL_BEGIN;
 
 /** Procedurally-generated texture driven by a noise algorithm.
  *  Wraps Texture with type/dimension/frequency/seed parameters
- *  and regenerates the underlying pixel data whenever they change.
+ *  and asynchronously regenerates the underlying pixel data whenever
+ *  they change.
  *  @sa Noise::create()
  */
 class SSS_GL_API Noise : public Texture {
+    friend SSS_GL_API void pollEverything();
+    friend class TiledNoise;
+
 public:
     using Shared = std::shared_ptr<Noise>;
 
@@ -67,121 +72,311 @@ public:
         Ridged, ///< Ridged multifractal — sharp ridges, good for mountains.
     };
 
+    /** Where the noise is generated. */
+    enum class Backend {
+        CPU, ///< FastNoise2 on a worker thread, pixels are then uploaded.
+        GPU, ///< Compute shader writing straight into the texture.
+    };
+
+    /** Every generation parameter, see corresponding setters for details.
+     *  Can be used as a builder, via create(Params const&) or setParams().
+     */
+    struct Params {
+        Type                 noise_type        { Type::Perlin };
+        int                  width             { 256 };
+        int                  height            { 256 };
+        float                frequency         { 0.02f };
+        int                  seed              { 1337 };
+
+        int                  depth             { 1 };
+        float                slice_step        { 1.0f };
+        std::chrono::nanoseconds slice_delay   { std::chrono::milliseconds(40) };
+
+        CellularDistanceFunc cell_dist_func    { CellularDistanceFunc::Euclidean };
+        CellularReturnType   cell_return_type  { CellularReturnType::Index0 };
+        float                cell_grid_jitter  { 1.0f };
+        float                cell_size_jitter  { 1.0f };
+        int                  cell_value_index  { 0 };
+        int                  cell_dist_index0  { 0 };
+        int                  cell_dist_index1  { 1 };
+
+        DomainWarpType       warp_type         { DomainWarpType::None };
+        float                warp_amplitude    { 1.0f };
+        float                warp_frequency    { 0.5f };
+
+        FractalType          fractal_type      { FractalType::None };
+        int                  fractal_octaves   { 3 };
+        float                fractal_lacunarity{ 2.0f };
+        float                fractal_gain      { 0.5f };
+
+        GLenum               format            { GL_RGBA8 };
+        std::vector<glm::vec4> color_ramp;
+
+        Backend              backend           { Backend::CPU };
+
+        bool operator==(Params const&) const = default;
+    };
+
     /** Creates a Noise texture with the given parameters and immediately generates it. */
     static Shared create(Type type = Type::Perlin, int width = 256, int height = 256,
                          float frequency = 0.02f, int seed = 1337);
+    /** Creates a Noise texture with the given parameters and immediately generates it. */
+    static Shared create(Params const& params);
+
+    // --- Batched edits ---
+
+    /** Replaces every parameter and schedules a single regeneration. */
+    void setParams(Params const& params);
+    Params const& getParams() const noexcept { return _params; }
+
+    /** Defers regenerations until the matching endEdit() call, so that
+     *  multiple setters only trigger a single generation. Can be nested.
+     *
+     *  Outside of edits, changes made between two pollEverything() calls
+     *  are coalesced as well: generation runs on a worker thread, and
+     *  the texture is updated on a later pollEverything() call.
+     */
+    void beginEdit() noexcept;
+    /** Ends an edit started with beginEdit(), scheduling a regeneration
+     *  if any parameter changed.
+     */
+    void endEdit();
+    /** Whether a regeneration is scheduled or running. */
+    bool isGenerating() const noexcept;
 
     // --- Core parameters ---
 
-    /** Sets the noise algorithm and regenerates. */
+    /** Sets the noise algorithm and schedules a regeneration. */
     void setNoiseType(Type type);
-    Type getNoiseType() const noexcept { return _noise_type; }
+    Type getNoiseType() const noexcept { return _params.noise_type; }
 
-    /** Resizes the texture and regenerates. */
+    /** Resizes the texture and schedules a regeneration. */
     void setDimensions(int width, int height);
-    int getWidth()  const noexcept { return _width; }
-    int getHeight() const noexcept { return _height; }
+    int getWidth()  const noexcept { return _params.width; }
+    int getHeight() const noexcept { return _params.height; }
 
-    /** Sets the noise frequency and regenerates. Smaller values = larger features. */
+    /** Sets the noise frequency and schedules a regeneration. Smaller values = larger features. */
     void setFrequency(float frequency);
-    float getFrequency() const noexcept { return _frequency; }
+    float getFrequency() const noexcept { return _params.frequency; }
 
-    /** Sets the noise seed and regenerates. */
+    /** Sets the noise seed and schedules a regeneration. */
     void setSeed(int seed);
-    int getSeed() const noexcept { return _seed; }
+    int getSeed() const noexcept { return _params.seed; }
+
+    // --- Volume options ---
+
+    /** Sets the amount of slices and schedules a regeneration.
+     *
+     *  With more than 1 slice, 3D noise is generated in a single batched
+     *  call, one slice per layer and frame, which planes play like any
+     *  animated texture (see Plane::play(), Plane::setAnimationFrame()).
+     *  Much faster than regenerating the noise on every frame.
+     */
+    void setDepth(int depth);
+    int getDepth() const noexcept { return _params.depth; }
+
+    /** Sets the Z distance between two slices, in pixels, and schedules a
+     *  regeneration. Smaller values = smoother animations.
+     */
+    void setSliceStep(float step);
+    float getSliceStep() const noexcept { return _params.slice_step; }
+
+    /** Sets the display duration of each slice and schedules a regeneration.*/
+    void setSliceDelay(std::chrono::nanoseconds delay);
+    std::chrono::nanoseconds getSliceDelay() const noexcept { return _params.slice_delay; }
 
     // --- Cellular options (active when type is CellularValue or CellularDistance) ---
 
-    /** Sets the cellular distance metric and regenerates. */
+    /** Sets the cellular distance metric and schedules a regeneration. */
     void setCellularDistanceFunc(CellularDistanceFunc func);
-    CellularDistanceFunc getCellularDistanceFunc() const noexcept { return _cell_dist_func; }
+    CellularDistanceFunc getCellularDistanceFunc() const noexcept { return _params.cell_dist_func; }
 
-    /** Sets the cellular return value type (CellularDistance only) and regenerates. */
+    /** Sets the cellular return value type (CellularDistance only) and schedules a regeneration. */
     void setCellularReturnType(CellularReturnType type);
-    CellularReturnType getCellularReturnType() const noexcept { return _cell_return_type; }
+    CellularReturnType getCellularReturnType() const noexcept { return _params.cell_return_type; }
 
-    /** Sets the jitter displacing feature points from their grid positions and regenerates. */
+    /** Sets the jitter displacing feature points from their grid positions and schedules a regeneration. */
     void setCellularGridJitter(float jitter);
-    float getCellularGridJitter() const noexcept { return _cell_grid_jitter; }
+    float getCellularGridJitter() const noexcept { return _params.cell_grid_jitter; }
 
-    /** Sets the jitter that varies cell sizes and regenerates. */
+    /** Sets the jitter that varies cell sizes and schedules a regeneration. */
     void setCellularSizeJitter(float jitter);
-    float getCellularSizeJitter() const noexcept { return _cell_size_jitter; }
+    float getCellularSizeJitter() const noexcept { return _params.cell_size_jitter; }
 
-    /** Sets which neighbor cell's value to use (CellularValue only) and regenerates. */
+    /** Sets which neighbor cell's value to use (CellularValue only) and schedules a regeneration. */
     void setCellularValueIndex(int index);
-    int getCellularValueIndex() const noexcept { return _cell_value_index; }
+    int getCellularValueIndex() const noexcept { return _params.cell_value_index; }
 
-    /** Sets the primary neighbor index for return-type combinations (CellularDistance only) and regenerates. */
+    /** Sets the primary neighbor index for return-type combinations (CellularDistance only) and schedules a regeneration. */
     void setCellularDistanceIndex0(int index);
-    int getCellularDistanceIndex0() const noexcept { return _cell_dist_index0; }
+    int getCellularDistanceIndex0() const noexcept { return _params.cell_dist_index0; }
 
-    /** Sets the secondary neighbor index for return-type combinations (CellularDistance only) and regenerates. */
+    /** Sets the secondary neighbor index for return-type combinations (CellularDistance only) and schedules a regeneration. */
     void setCellularDistanceIndex1(int index);
-    int getCellularDistanceIndex1() const noexcept { return _cell_dist_index1; }
+    int getCellularDistanceIndex1() const noexcept { return _params.cell_dist_index1; }
 
     // --- Domain warp options ---
 
-    /** Sets the domain warp algorithm and regenerates. */
+    /** Sets the domain warp algorithm and schedules a regeneration. */
     void setDomainWarpType(DomainWarpType type);
-    DomainWarpType getDomainWarpType() const noexcept { return _warp_type; }
+    DomainWarpType getDomainWarpType() const noexcept { return _params.warp_type; }
 
-    /** Sets the domain warp amplitude and regenerates. Larger = more distortion. */
+    /** Sets the domain warp amplitude and schedules a regeneration. Larger = more distortion. */
     void setDomainWarpAmplitude(float amplitude);
-    float getDomainWarpAmplitude() const noexcept { return _warp_amplitude; }
+    float getDomainWarpAmplitude() const noexcept { return _params.warp_amplitude; }
 
-    /** Sets the domain warp frequency and regenerates. */
+    /** Sets the domain warp frequency and schedules a regeneration. */
     void setDomainWarpFrequency(float frequency);
-    float getDomainWarpFrequency() const noexcept { return _warp_frequency; }
+    float getDomainWarpFrequency() const noexcept { return _params.warp_frequency; }
 
     // --- Fractal options ---
 
-    /** Sets the fractal layering algorithm and regenerates. */
+    /** Sets the fractal layering algorithm and schedules a regeneration. */
     void setFractalType(FractalType type);
-    FractalType getFractalType() const noexcept { return _fractal_type; }
+    FractalType getFractalType() const noexcept { return _params.fractal_type; }
 
-    /** Sets the number of fractal octaves [1-8] and regenerates. */
+    /** Sets the number of fractal octaves [1-8] and schedules a regeneration. */
     void setFractalOctaves(int octaves);
-    int getFractalOctaves() const noexcept { return _fractal_octaves; }
+    int getFractalOctaves() const noexcept { return _params.fractal_octaves; }
 
-    /** Sets the frequency multiplier per fractal octave and regenerates. */
+    /** Sets the frequency multiplier per fractal octave and schedules a regeneration. */
     void setFractalLacunarity(float lacunarity);
-    float getFractalLacunarity() const noexcept { return _fractal_lacunarity; }
+    float getFractalLacunarity() const noexcept { return _params.fractal_lacunarity; }
 
-    /** Sets the amplitude multiplier per fractal octave and regenerates. */
+    /** Sets the amplitude multiplier per fractal octave and schedules a regeneration. */
     void setFractalGain(float gain);
-    float getFractalGain() const noexcept { return _fractal_gain; }
-
-    /** Unconditionally regenerates the noise texture with the current parameters. */
+    float getFractalGain() const noexcept { return _params.fractal_gain; }
+
+    // --- Output ---
+
+    /** Sets the texture internal format and schedules a regeneration.
+     *  \c GL_R8 and \c GL_R32F skip the RGBA expansion altogether and
+     *  are displayed as grayscale, any other value means \c GL_RGBA8.
+     *  Ignored by Backend::GPU, which always outputs \c GL_RGBA8.
+     */
+    void setFormat(GLenum format);
+    GLenum getFormat() const noexcept { return _params.format; }
+
+    /** Sets evenly spaced colors (0-1 range) the noise is mapped through
+     *  instead of grayscale, and schedules a regeneration.
+     *  Only applies to \c GL_RGBA8 CPU output, empty for grayscale.
+     *  @sa Texture::makeColorRamp()
+     */
+    void setColorRamp(std::vector<glm::vec4> const& colors);
+    std::vector<glm::vec4> const& getColorRamp() const noexcept { return _params.color_ramp; }
+
+    // --- Backend ---
+
+    /** Sets where the noise is generated and schedules a regeneration.
+     *
+     *  Backend::GPU runs a compute shader on the GL thread during
+     *  pollEverything(), without any worker, CPU conversion nor upload,
+     *  which suits noise animated every frame. Its output closely
+     *  follows the CPU one but isn't bit-identical. No pixels are kept
+     *  on the CPU: the texture is considered fully opaque by hit tests
+     *  and is never evicted (see Texture::setMemoryBudget()).
+     */
+    void setBackend(Backend backend);
+    Backend getBackend() const noexcept { return _params.backend; }
+
+    // --- Result cache ---
+
+    /** Sets the byte budget of the process-wide result cache
+     *  (default: 64 MiB, 0 disables it).
+     *
+     *  Results are keyed by their full Params, so that switching back to
+     *  previous parameters is instant: CPU results are uploaded again,
+     *  and GPU ones copied from a cached texture. The least recently
+     *  used results are dropped to fit the budget.
+     */
+    static void setCacheBudget(size_t bytes);
+    static size_t getCacheBudget() noexcept { return _cache_budget; }
+    /** Returns the bytes currently held by the result cache.*/
+    static size_t getCacheSize() noexcept { return _cache_bytes; }
+    /** Drops every cached result (files in the cache folder are kept).*/
+    static void clearCache() noexcept;
+
+    /** Sets a folder where CPU results are persisted across runs, empty
+     *  to disable (default). Like Texture::setResourceFolder(), given
+     *  path is prepended as is to file names, and should thus end with
+     *  a separator. Files are read & written on worker threads.
+     */
+    static void setCacheFolder(std::string const& folder);
+    static std::string getCacheFolder() { return _cache_folder; }
+
+    /** Unconditionally and synchronously regenerates the noise texture
+     *  with the current parameters, cancelling any scheduled regeneration.
+     */
     void regenerate();
 
 private:
     Noise();
 
-    Type                 _noise_type       { Type::Perlin };
-    int                  _width            { 256 };
-    int                  _height           { 256 };
-    float                _frequency        { 0.02f };
-    int                  _seed             { 1337 };
-
-    CellularDistanceFunc _cell_dist_func   { CellularDistanceFunc::Euclidean };
-    CellularReturnType   _cell_return_type { CellularReturnType::Index0 };
-    float                _cell_grid_jitter { 1.0f };
-    float                _cell_size_jitter { 1.0f };
-    int                  _cell_value_index { 0 };
-    int                  _cell_dist_index0 { 0 };
-    int                  _cell_dist_index1 { 1 };
-
-    DomainWarpType       _warp_type        { DomainWarpType::None };
-    float                _warp_amplitude   { 1.0f };
-    float                _warp_frequency   { 0.5f };
-
-    FractalType          _fractal_type     { FractalType::None };
-    int                  _fractal_octaves  { 3 };
-    float                _fractal_lacunarity{ 2.0f };
-    float                _fractal_gain     { 0.5f };
-
-    void _generate();
+    Params _params;                 // Current parameters
+    int _edit_depth{ 0 };           // Nested beginEdit() calls
+    bool _dirty{ false };           // Parameters changed during an edit
+
+    // Instances waiting for their worker, launched by pollEverything()
+    static std::set<Noise*> _pending;
+
+    // Marks parameters as changed, and schedules a generation unless editing
+    void _invalidate();
+    // Runs workers of pending instances which aren't already generating
+    static void _pollPending();
+
+    // Returns the internal format of generated textures
+    static GLenum _format(Params const& params) noexcept;
+    // Sets up one empty frame per slice, each owning its layer
+    static void _setupSlices(Params const& params, Frame::Vector& frames);
+    // Generates every slice for given parameters, callable from any thread.
+    // Fills frame pixels for GL_RGBA8, frame blocks otherwise.
+    // Offsets are in pixels, so that adjacent grids join seamlessly.
+    static void _generate(Params const& params, Frame::Vector& frames, int x_offset = 0, int y_offset = 0);
+    // Replaces the texture content with generated frames
+    void _applyFrames(Frame::Vector&& frames);
+    // Generates the texture via the noise compute shader, GL thread only
+    void _generateGPU();
+
+    virtual void _subjectUpdate(Subject const& subject, SSS::Event const& event) override;
+
+    // Cached result, either CPU frames or a GPU texture copy
+    struct _CacheEntry {
+        Frame::Vector frames;
+        std::unique_ptr<Basic::Texture> texture;
+        size_t bytes{ 0 };
+        uint64_t last_used{ 0 };
+    };
+    static std::unordered_map<std::string, _CacheEntry> _cache;
+    static size_t _cache_budget;    // 0 if disabled
+    static size_t _cache_bytes;     // Sum of entry bytes
+    static uint64_t _cache_clock;   // Incremented by each lookup
+    static std::string _cache_folder;
+
+    // Serializes every parameter, used as cache key & file header
+    static std::string _cacheKey(Params const& params);
+    // Returns the cached result of given key, or nullptr
+    static _CacheEntry* _cacheFind(std::string const& key);
+    // Stores a result, unless larger than the whole budget
+    static void _cacheStore(std::string const& key, _CacheEntry&& entry);
+    // Drops least recently used results until given budget is met
+    static void _cacheTrim(size_t budget) noexcept;
+    // Reads or writes a CPU result in given folder, callable from any thread.
+    // Files failing to open or whose header doesn't match are ignored.
+    static bool _loadFile(std::string const& folder, Params const& params, Frame::Vector& frames);
+    static void _saveFile(std::string const& folder, Params const& params, Frame::Vector const& frames);
+    // Applies a cached CPU result, returns false on cache miss
+    bool _applyCached();
+
+    // Async class generating pixels with given parameters, and reading
+    // or writing them in given cache folder, if any
+    class _AsyncGenerating : public Async<Params, std::string> {
+        friend Noise;
+    protected:
+        virtual void _asyncFunction(Params params, std::string folder);
+    private:
+        Params _params;             // Parameters of _generated
+        Frame::Vector _generated;   // Generated slices
+    } _generating_thread;
 };
 
 #pragma warning(pop)
@@ -53,7 +53,13 @@ public:
         /** SDF plane shaders, used by Plane::Renderer for planes with sdf_mode != None.*/
         PlaneSDF,
         /** UI SDF shape shaders, used by UIRenderer for Node_UI primitives.*/
-        UIShape
+        UIShape,
+        /** Noise compute shader, used by Noise with Noise::Backend::GPU.*/
+        NoiseCompute,
+        /** Instanced segment shaders, used by InstancedLineRenderer by default.*/
+        InstancedLine,
+        /** Plane picking shaders, used by Plane::Renderer with Window::PickingMode::GPU.*/
+        PlanePicking
     };
 
     using InstancedClass::create;
@@ -73,14 +79,27 @@ public:
      *  @sa loadFromStrings()
      */
     void loadFromFiles(std::filesystem::path const& vertex_fp, std::filesystem::path const& fragment_fp);
+    /** Loads a compute shader from a raw string (useful for Preset shaders).
+     *  Context will always be accurately set.
+     *  @sa dispatch()
+     */
+    void loadComputeFromString(std::string const& compute_data);
 
     inline std::string getVertexData() const noexcept { return _vertex_data; };
     inline std::string getFragmentData() const noexcept { return _fragment_data; };
+    inline std::string getComputeData() const noexcept { return _compute_data; };
+    /** Whether the program was loaded from a compute shader.*/
+    inline bool isCompute() const noexcept { return !_compute_data.empty(); };
 
     /** Simple handle to \c glUseProgram().
      *  Context will always be accurately set.
      */
     void use() const;
+    /** Simple handle to \c glDispatchCompute(), program must be in use.
+     *  Context will always be accurately set.
+     *  @sa loadComputeFromString()
+     */
+    void dispatch(GLuint groups_x, GLuint groups_y, GLuint groups_z = 1) const;
 
     
 
@@ -151,6 +170,7 @@ private:
     GLuint _program_id{ 0 };
     // Shaders data
     std::string _vertex_data, _fragment_data;
+    std::string _compute_data;
 
     // Files, watch and hot reloading
     std::filesystem::file_time_type _vert_last_write;
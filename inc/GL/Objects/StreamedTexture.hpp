@@ -0,0 +1,92 @@
+#ifndef SSS_GL_STREAMED_TEXTURE_HPP
+#define SSS_GL_STREAMED_TEXTURE_HPP
+
+#include "Texture.hpp"
+
+/** @file
+ *  Defines class SSS::GL::StreamedTexture.
+ */
+
+SSS_GL_BEGIN;
+
+// Ignore warning about STL exports as they're private members
+#pragma warning(push, 2)
+#pragma warning(disable: 4251)
+#pragma warning(disable: 4275)
+
+/** Animated Texture decoding its frames on the fly, keeping only a
+ *  small ring of layers resident instead of the whole animation.
+ *
+ *  Frame delays are read upfront, so planes play it like any other
+ *  Texture. Frames ahead of the playback position are decoded on a
+ *  worker thread and uploaded to a free ring layer just before being
+ *  displayed, which bounds memory by the ring size rather than by the
+ *  animation length.
+ *
+ *  Only (A)PNG files are supported. The playback position is the one
+ *  of the last plane which advanced, so planes sharing a StreamedTexture
+ *  should play in sync.
+ *  @sa StreamedTexture::create()
+ */
+class SSS_GL_API StreamedTexture : public Texture {
+public:
+    using Shared = std::shared_ptr<StreamedTexture>;
+
+    ~StreamedTexture();
+
+    /** Creates a StreamedTexture and starts streaming given file.
+     *  @param ring_size Maximum amount of resident frames (at least 2).
+     *  @sa loadStream()
+     */
+    static Shared create(std::string const& filepath, uint32_t ring_size = 8);
+
+    /** Asynchronously opens the (A)PNG file at given path (can be relative
+     *  or absolute) and starts decoding its first frames. Whenever the
+     *  file is read, the next call to pollEverything() sets up the frames.
+     */
+    void loadStream(std::string const& filepath);
+
+    /** Returns the maximum amount of resident frames.*/
+    inline uint32_t getRingSize() const noexcept { return _ring_size; };
+
+private:
+    StreamedTexture(uint32_t ring_size);
+
+    virtual void _subjectUpdate(Subject const& subject, SSS::Event const& event) override;
+    virtual void _frameRequested(uint32_t frame) override;
+
+    // Runs the worker on the first window frame which isn't resident
+    void _decodeAhead();
+    // Uploads a decoded frame in a layer holding no window frame
+    void _upload(uint32_t frame, RGBA32::Vector&& pixels);
+    // Points frames which aren't resident at the layer of the last resident
+    // frame before them. Returns whether any layer changed.
+    bool _remapPending();
+    // Whether given frame is in [_playback, _playback + ring)
+    bool _inWindow(uint32_t frame) const noexcept;
+
+    // Async class decoding frames one by one with an APNGReader
+    class _AsyncDecoding : public Async<std::string, uint32_t, uint32_t> {
+        friend StreamedTexture;
+    protected:
+        virtual void _asyncFunction(std::string path, uint32_t first, uint32_t count);
+    private:
+        std::string _path;                  // Currently streamed file
+        _internal::APNGReader _reader;      // Reader of _path
+        uint32_t _frame_count{ 0 };         // Amount of frames in _path
+        uint32_t _position{ 0 };            // Frame returned by the next _reader.next()
+        _internal::APNGFrame _scratch;      // Reused decoding buffer
+        std::vector<_internal::APNGFrame> _scanned; // Delays, when a new file was opened
+        std::vector<std::pair<uint32_t, RGBA32::Vector>> _decoded; // Decoded frames
+    } _decoding_thread;
+
+    uint32_t _ring_size;            // Maximum amount of resident frames
+    uint32_t _playback{ 0 };        // Last requested frame
+    std::vector<uint32_t> _slots;   // Frame held by each layer, or UINT32_MAX
+};
+
+#pragma warning(pop)
+
+SSS_GL_END;
+
+#endif // SSS_GL_STREAMED_TEXTURE_HPP
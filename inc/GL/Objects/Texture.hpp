@@ -5,6 +5,8 @@
 #include <SSS/Commons/eventList.hpp>
 #include "Basic.hpp"
 #include "glm/glm.hpp"
+#include <array>
+#include <set>
 
 
 /** @file
@@ -31,6 +33,50 @@ struct APNGFrame {
     unsigned int w{ 0 }, h{ 0 }, delay_num{ 0 }, delay_den{ 0 };
 };
 int load_apng(char const* filepath, std::vector<APNGFrame>& frames);
+// Reads frame dimensions & delays without decoding any pixel
+int scan_apng(char const* filepath, std::vector<APNGFrame>& frames);
+
+// Incremental APNG decoder, composing frames one at a time
+class APNGReader {
+public:
+    APNGReader();
+    APNGReader(APNGReader const&) = delete;
+    APNGReader& operator=(APNGReader const&) = delete;
+    ~APNGReader();
+
+    // Opens given file and reads its header, returns false if not a PNG
+    bool open(char const* filepath);
+    // Closes the file, if any
+    void close();
+    // Decodes the next frame, returns false once every frame was read
+    bool next(APNGFrame& frame);
+    // Whether the default image is not part of the animation
+    bool skipsFirst() const noexcept;
+
+private:
+    struct _State;
+    std::unique_ptr<_State> _state;
+};
+
+// Image stored in a KTX2 container, one array layer per frame
+struct KTX2Image {
+    // GL_RGBA8, or a compressed format (see Basic::Texture::compressedSize())
+    GLenum format{ GL_RGBA8 };
+    unsigned int w{ 0 }, h{ 0 };
+    std::vector<std::vector<uint8_t>> layers;
+    // Frame delays in ns, empty if not animated
+    std::vector<int64_t> delays;
+};
+// Reads level 0 of every layer, supercompressed files are not supported
+int load_ktx2(char const* filepath, KTX2Image& image);
+int save_ktx2(char const* filepath, KTX2Image const& image);
+// Compresses RGBA8 pixels in 4x4 blocks of 16 bytes, edges are clamped
+void encode_bc3(uint8_t const* rgba, unsigned int w, unsigned int h, std::vector<uint8_t>& blocks);
+void encode_bc7(uint8_t const* rgba, unsigned int w, unsigned int h, std::vector<uint8_t>& blocks);
+// Fills a 1 bit per pixel (alpha != 0) mask from BC1, BC3 or BC7 blocks.
+// Returns false for other formats, which have no CPU alpha.
+bool decode_alpha_mask(GLenum format, uint8_t const* blocks, unsigned int w, unsigned int h,
+    std::vector<uint64_t>& mask);
 
 INTERNAL_END;
 
@@ -47,6 +93,8 @@ INTERNAL_END;
 class SSS_GL_API Texture : public Observer, public Subject, public InstancedClass<Texture>, public _EventRegistry<Texture> {
     friend SharedClass;
     friend _EventRegistry<Texture>;
+    friend class PlaneBase;
+    friend SSS_GL_API void pollEverything();
 
 protected:
     Texture();
@@ -66,6 +114,20 @@ public:
      */
     static Shared createCellularNoise(int width, int height, float frequency = 0.02f, int seed = 1337);
 
+    /** Converts noise values in a -1/+1 range to texels of given internal
+     *  format (\c GL_RGBA8, \c GL_R8 or \c GL_R32F), in place: \c data
+     *  holds \c count floats on input and \c count texels on output,
+     *  ready for editRawPixels() or editRawTexels(). Vectorized with SSE2.
+     *  @param ramp Optional colors \c GL_RGBA8 output is mapped through
+     *  instead of grayscale, see makeColorRamp().
+     */
+    static void convertNoise(float* data, size_t count, GLenum format = GL_RGBA8,
+        std::array<RGBA32, 256> const* ramp = nullptr) noexcept;
+    /** Interpolates evenly spaced colors (0-1 range) into a ramp for
+     *  convertNoise(). A single color fills the whole ramp.
+     */
+    static std::array<RGBA32, 256> makeColorRamp(std::vector<glm::vec4> const& colors);
+
     /** The Texture type, mainly to know which pixels to use (internal or TR).
      *  @sa setType(), getType()
      */
@@ -90,10 +152,18 @@ public:
     };
 
     struct Frame {
-        // Pixel array
+        // Pixel array, empty for frames sharing the layer of a previous one
         RGBA32::Vector pixels;
+        // Compressed blocks or single-channel texels, used instead of
+        // pixels when Vector::format isn't GL_RGBA8
+        std::vector<uint8_t> blocks;
+        // 1 bit per pixel (alpha != 0), row major, filled when pixels are
+        // released, or when compressed blocks are loaded
+        std::vector<uint64_t> alpha_mask;
         // Delay, in ns for precision. 40ms would be 25FPS
-        std::chrono::nanoseconds delay;
+        std::chrono::nanoseconds delay{ 0 };
+        // GPU layer holding this frame's pixels (identical frames share one)
+        uint32_t layer{ 0 };
         // Vector
         class Vector : public std::vector<Frame> {
         public:
@@ -103,24 +173,129 @@ public:
             std::chrono::nanoseconds total_time;
             int w{ 0 };
             int h{ 0 };
+            // GPU internal format, GL_RGBA8 unless loaded from a compressed
+            // KTX2 file or edited via editRawTexels()
+            GLenum format{ GL_RGBA8 };
+            // Index of the frame owning the pixels of each GPU layer
+            std::vector<uint32_t> layers;
+            // Time at which each frame ends (prefix sums of delays)
+            std::vector<std::chrono::nanoseconds> end_times;
+
+            /** Maps identical frames to a single GPU layer, freeing the
+             *  pixels of duplicates and filling the layers table.
+             *  Must be called on freshly filled frames, before any upload.
+             */
+            void deduplicate();
+            /** Replaces the pixels or blocks of each layer owner by its alpha mask.*/
+            void releasePixels();
+            /** Fills end_times and total_time from frame delays.
+             *  Called on each upload, see frameAt().
+             */
+            void computeTimings();
+            /** Returns the frame displayed at given time, in
+             *  [0, total_time), via a binary search in end_times.
+             */
+            uint32_t frameAt(std::chrono::nanoseconds time) const noexcept;
+            /** Returns the GPU layer of given frame, or 0 if out of range.*/
+            inline uint32_t layerOf(size_t frame) const noexcept {
+                return frame < size() ? (*this)[frame].layer : 0;
+            };
+            /** Returns the pixels displayed by given frame, which may be
+             *  owned by a previous identical frame.
+             */
+            inline RGBA32::Vector const& pixelsOf(size_t frame) const {
+                return at(layers.at(at(frame).layer)).pixels;
+            };
         };
     };
 
     inline static void setResourceFolder(std::string const& path) { _resource_folder = path; };
     inline static std::string getResourceFolder() { return _resource_folder; };
 
+    /** Block compression formats convertToKTX2() can encode.*/
+    enum class Compression {
+        /** BPTC (mode 6), best quality, 1 byte per pixel.*/
+        BC7,
+        /** S3TC DXT5, widest desktop support, 1 byte per pixel.*/
+        BC3
+    };
+    /** Converts given image (APNG or any stb_image format) to a KTX2 file
+     *  of given compression, with one array layer per frame.
+     *  Blocking and CPU only, meant for offline tools (see tools/ktx2-convert).
+     *  @sa setCompressedVariants()
+     */
+    static void convertToKTX2(std::string const& src, std::string const& dst,
+        Compression compression);
+
+    /** When enabled, loadImage("name.png") loads the first existing
+     *  "name.bc7.ktx2", "name.etc2.ktx2" or "name.bc3.ktx2" file whose
+     *  format is supported by the driver, and "name.png" otherwise.
+     *  KTX2 files are also accepted directly, and fall back to their
+     *  "name.png" sibling when their format isn't supported.
+     *  Default: disabled.
+     *  @sa Window::isCompressedFormatSupported()
+     */
+    inline static void setCompressedVariants(bool enable) noexcept { _compressed_variants = enable; };
+    inline static bool getCompressedVariants() noexcept { return _compressed_variants; };
+
+    /** Texture memory usage, see setMemoryBudget().*/
+    struct MemoryStats {
+        /** Current budget in bytes, 0 if unlimited.*/
+        size_t budget{ 0 };
+        /** Bytes allocated by every Basic::Texture, Texture or not.*/
+        size_t allocated_bytes{ 0 };
+        /** Bytes held on the GPU by Texture instances.*/
+        size_t resident_bytes{ 0 };
+        /** Bytes of evicted Texture instances, restored when bound.*/
+        size_t evicted_bytes{ 0 };
+        uint32_t resident_count{ 0 };
+        uint32_t evicted_count{ 0 };
+        /** Evictions & restorations since startup.*/
+        uint64_t evictions{ 0 };
+        uint64_t restorations{ 0 };
+    };
+
+    /** Sets the GPU memory budget of all Texture instances, in bytes
+     *  (default: 0, unlimited).
+     *
+     *  When exceeded, pollEverything() frees the GPU storage of the least
+     *  recently bound textures which weren't bound since the previous
+     *  poll, until usage fits the budget. Their CPU copy is kept, and the
+     *  storage is silently restored on their next bind().
+     *  @sa getMemoryStats()
+     */
+    inline static void setMemoryBudget(size_t bytes) noexcept { _memory_budget = bytes; };
+    inline static size_t getMemoryBudget() noexcept { return _memory_budget; };
+    /** Returns live GPU residency stats of Texture instances.*/
+    static MemoryStats getMemoryStats() noexcept;
+    /** Whether the GPU storage is allocated (see setMemoryBudget()).*/
+    inline bool isResident() const noexcept { return !_raw_texture.isReleased(); };
+
 private:
     static std::string _resource_folder;
+    static bool _compressed_variants;
 
+    static std::set<Texture*> _registry;    // Every instance, for eviction
+    static size_t _memory_budget;           // 0 if unlimited
+    static uint64_t _poll_count;            // Incremented by each pollEverything()
+    static uint64_t _evictions;
+    static uint64_t _restorations;
+    uint64_t _last_bound{ 0 };              // _poll_count of the last bind()
+
+protected:
     //static Basic::Texture 
     Basic::Texture _raw_texture;    // OpenGL texture
+private:
     Type _type{ Type::Raw };        // Texture type
     UVMode _uv_mode{ UVMode::Cartesian }; // UV coordinate mapping mode
     glm::vec2 _uv_offset{ 0.f, 0.f };  // Offset applied to UV coordinates before sampling (meaning depends on _uv_mode)
     bool _repeat{ false };                // Whether the texture wraps (GL_REPEAT) or clamps (GL_CLAMP_TO_EDGE)
+protected:
     Frame::Vector _frames;     // Vector of frames (is used for images AND animations). Default constructed to avoid MSVC ambiguity with int -> Frame::Vector conversion
+private:
     TR::Area::Shared _area;         // TR::Area
     std::string _filepath;          // Image filepath
+    bool _keep_pixels{ true };      // Whether pixels are kept once uploaded
     std::function<void(Texture&)> _callback_f;
 
 public:
@@ -181,10 +356,40 @@ public:
      *  @sa getRawPixels, getRawDimensions()
      */
     void editRawPixels(void const* pixels, int width, int height);
+    /** Edits the raw pixels of this instance, without copying them.*/
+    void editRawPixels(RGBA32::Vector&& pixels, int width, int height);
+    /** Edits the raw texels of this instance, in given uncompressed
+     *  internal format (see Basic::Texture::texelFormat()).
+     *  Single-channel formats are displayed as grayscale, and are
+     *  considered fully opaque by isOpaque().
+     */
+    void editRawTexels(std::vector<uint8_t>&& texels, int width, int height, GLenum format);
 
     void setColor(RGBA32 color);
 
-    inline auto const& getRawPixels(size_t id = 0) const noexcept { return _frames.at(id).pixels; };
+    /** Returns the pixels displayed by given frame.
+     *  Identical frames share the same pixels.
+     *  Empty if pixels aren't kept, see setKeepPixels().
+     */
+    inline auto const& getRawPixels(size_t id = 0) const { return _frames.pixelsOf(id); };
+
+    /** Sets whether decoded pixels are kept in RAM once uploaded (default: true).
+     *  When disabled, each frame only keeps a 1-bit alpha mask for
+     *  isOpaque(), and getRawPixels() returns empty vectors. This includes
+     *  single-channel texels and compressed blocks. Released pixels can't
+     *  be retrieved back, and textures without pixels are never evicted
+     *  (see setMemoryBudget()).
+     */
+    void setKeepPixels(bool keep);
+    /** Returns whether decoded pixels are kept in RAM once uploaded.*/
+    inline bool getKeepPixels() const noexcept { return _keep_pixels; };
+
+    /** Returns whether the pixel at given coordinates of given frame has
+     *  a non-zero alpha. Uses pixels when kept, alpha masks otherwise.
+     *  BC1, BC3 & BC7 frames get their alpha masks when loaded, ETC2 and
+     *  single-channel frames have no CPU alpha and are considered opaque.
+     */
+    bool isOpaque(size_t frame, int x, int y) const;
 
     inline auto const& getFrames() const noexcept { return _frames; };
 
@@ -203,9 +408,10 @@ public:
     inline TR::Area::Shared getTextArea() const noexcept { return _area; };
     
     /** Binds the internal Basic::Texture to the content in which it was created.
-     *  Effectively calls Basic::Texture::bind().
+     *  Effectively calls Basic::Texture::bind(), after restoring the GPU
+     *  storage if it was evicted (see setMemoryBudget()).
      */
-    inline void bind() const { _raw_texture.bind(); };
+    void bind();
     /** Returns the internal Basic::Texture's ID.
      *  If you wish to %bind the internal texture, call bind().
      */
@@ -216,27 +422,43 @@ public:
 
     void savePNG() const;
 
-private:
+protected:
 
     virtual void _subjectUpdate(Subject const& subject, SSS::Event const& event) override;
+    // Called by planes whenever their animation reaches given frame
+    virtual void _frameRequested(uint32_t frame) {};
+    // Simple internal edit based on set type
+    void _internalEdit(Type type);
+    // Same as _internalEdit(), without notifying. Returns true if resized.
+    bool _internalEditQuiet(Type type);
+    // Emits edit events & calls the update callback, see _internalEditQuiet()
+    void _notifyEdit(bool resized);
+    // Uploads current pixels based on set type, returns true if resized
+    bool _internalUpload();
 
+private:
     // Async class which fills _raw_pixels using stb_image
     class _AsyncLoading : public Async<std::string, std::string> {
         friend Texture;
     protected:
         virtual void _asyncFunction(std::string folder, std::string filepath);
     private:
+        // Fills _frames based on the extension of given resolved path
+        void _load(std::string const& path);
         Frame::Vector _frames;
     } _loading_thread;
 
-    // Simple internal edit based on set type
-    void _internalEdit(Type type);
     // Applies GL_TEXTURE_WRAP_S/T based on current _uv_mode & _repeat.
     // Polar mode needs the angle axis (S) to wrap independently of the
     // radius axis (T), which must always clamp -- a single _repeat flag
     // driving both axes can't express that.
     void _updateWrapParams() noexcept;
 
+    // Whether the GPU storage can be restored from a CPU copy
+    bool _isEvictable() const noexcept;
+    // Evicts least recently bound instances until the budget is met
+    static void _enforceBudget();
+
     static void _register();
 };
 
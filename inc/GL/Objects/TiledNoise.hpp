@@ -0,0 +1,109 @@
+#ifndef SSS_GL_TILED_NOISE_HPP
+#define SSS_GL_TILED_NOISE_HPP
+
+#include "Noise.hpp"
+#include <map>
+
+/** @file
+ *  Defines class SSS::GL::TiledNoise.
+ */
+
+SSS_GL_BEGIN;
+
+// Ignore warning about STL exports as they're private members
+#pragma warning(push, 2)
+#pragma warning(disable: 4251)
+#pragma warning(disable: 4275)
+
+/** Infinite noise field, generated in tiles around a visible area.
+ *
+ *  Each tile is a Noise::Params::width x height grid sampled at its own
+ *  world offset, so that neighbouring tiles join seamlessly. Tiles are
+ *  generated on a worker thread and uploaded to a texture layer on a
+ *  later pollEverything() call. Layers act as an LRU cache: once they're
+ *  all taken, the least recently visible tile is replaced.
+ *
+ *  A resident tile's layer is also the frame displaying it, eg:
+ *  \c plane->setAnimationFrame(noise->getTileLayer(x, y)).
+ *  Layers may be reassigned whenever \c SSS_TEXTURE_CONTENT is emitted.
+ *  @sa TiledNoise::create(), setVisibleArea()
+ */
+class SSS_GL_API TiledNoise : public Texture {
+public:
+    using Shared = std::shared_ptr<TiledNoise>;
+    /** Tile coordinates, in tiles (not pixels).*/
+    using TileCoords = std::pair<int, int>;
+
+    ~TiledNoise();
+
+    /** Creates a TiledNoise, with width and height of given parameters
+     *  being the dimensions of a single tile. Tiles are always
+     *  generated on the CPU and flat: Noise::Params::backend and
+     *  Noise::Params::depth are ignored.
+     *  @param tile_capacity Maximum amount of resident tiles (at least 1).
+     */
+    static Shared create(Noise::Params const& params, uint32_t tile_capacity = 16);
+
+    /** Replaces every parameter, discarding all generated tiles.*/
+    void setParams(Noise::Params const& params);
+    /** Returns the current parameters.*/
+    inline Noise::Params const& getParams() const noexcept { return _params; };
+
+    /** Sets the world area (in pixels, max excluded) whose tiles should
+     *  be resident, and schedules the generation of missing ones,
+     *  closest to the center first.
+     *  If the area spans more tiles than the capacity, only the closest
+     *  ones are generated.
+     */
+    void setVisibleArea(int x_min, int y_min, int x_max, int y_max);
+
+    /** Returns the coordinates of the tile holding given world pixel.*/
+    TileCoords getTileCoords(int x, int y) const noexcept;
+    /** Returns the layer (and frame) holding given tile, or -1 if
+     *  it isn't resident yet.
+     */
+    int getTileLayer(int tile_x, int tile_y) const noexcept;
+    /** Whether every visible tile is resident.*/
+    bool isComplete() const noexcept;
+
+    /** Returns the maximum amount of resident tiles.*/
+    inline uint32_t getTileCapacity() const noexcept { return _tile_capacity; };
+
+private:
+    TiledNoise(Noise::Params const& params, uint32_t tile_capacity);
+
+    virtual void _subjectUpdate(Subject const& subject, SSS::Event const& event) override;
+
+    // Sets up empty layers, discarding every tile
+    void _reset();
+    // Runs the worker on missing visible tiles, if not already running
+    void _generateMissing();
+    // Uploads a generated tile in a free or least recently visible layer
+    bool _upload(TileCoords const& tile, Frame&& frame);
+    // Whether given tile is part of the visible area
+    bool _isVisible(TileCoords const& tile) const noexcept;
+
+    // Async class generating tiles one by one
+    class _AsyncGenerating : public Async<Noise::Params, std::vector<TileCoords>> {
+        friend TiledNoise;
+    protected:
+        virtual void _asyncFunction(Noise::Params params, std::vector<TileCoords> tiles);
+    private:
+        Noise::Params _params;  // Parameters of _generated
+        std::vector<std::pair<TileCoords, Frame>> _generated; // Generated tiles
+    } _generating_thread;
+
+    Noise::Params _params;              // Current parameters
+    uint32_t _tile_capacity;            // Maximum amount of resident tiles
+    std::vector<TileCoords> _visible;   // Visible tiles, closest to the center first
+    std::map<TileCoords, uint32_t> _resident;  // Layer of each resident tile
+    std::vector<TileCoords> _slots;     // Tile held by each layer
+    std::vector<uint64_t> _last_visible;// Last visibility stamp of each layer, 0 if free
+    uint64_t _visibility_stamp{ 0 };    // Incremented by setVisibleArea()
+};
+
+#pragma warning(pop)
+
+SSS_GL_END;
+
+#endif // SSS_GL_TILED_NOISE_HPP
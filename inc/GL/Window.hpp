@@ -4,6 +4,7 @@
 #include "Objects/Basic.hpp"
 #include <map>
 #include <array>
+#include <algorithm>
 #include <queue>
 
 #include <SSS/Commons/eventList.hpp>
@@ -44,6 +45,7 @@ SSS_GL_BEGIN;
 class Shaders;
 class RendererBase;
 class ModelBase;
+class PlaneBase;
 class Camera;
 
 class SSS_GL_API Context {
@@ -111,6 +113,7 @@ private:
         std::map<uint32_t, std::shared_ptr<Shaders>> _preset_shaders;
         std::vector<GLFWmonitor*> _monitors;
         uint32_t _max_glsl_tex_units{ 0 };
+        std::vector<GLenum> _compressed_formats;
     };
 
     bool _is_main;
@@ -274,6 +277,27 @@ public:
     }
     std::shared_ptr<Camera> getHoveredCam() const noexcept { return _hovered.camera.lock(); };
 
+    /** Methods used to find the hovered model.
+     *  @sa setPickingMode()
+     */
+    enum class PickingMode {
+        /** Planes are tested against the cursor on the CPU (default).*/
+        CPU,
+        /** Planes draw their IDs under the cursor, which are read back
+         *  asynchronously. The hovered model lags a frame or two behind,
+         *  but picking costs don't depend on the amount of planes.
+         */
+        GPU
+    };
+    /** Sets the method used to find the hovered model.
+     *  @sa getPickingMode()
+     */
+    void setPickingMode(PickingMode mode);
+    /** Returns the method used to find the hovered model.
+     *  @sa setPickingMode()
+     */
+    inline PickingMode getPickingMode() const noexcept { return _picking_mode; };
+
     std::shared_ptr<ModelBase> getClicked() const { return _clicked.model.lock(); };
     template<class Derived>
     std::shared_ptr<Derived> getClicked() const {
@@ -344,6 +368,26 @@ private:
     _ModelData _held;       // (left click)
     void _updateHoveredModel();
     void _updateHoveredModelIfNeeded(std::chrono::steady_clock::time_point const& now);
+    void _logHoveredModel() const;
+
+    // Picking pass resources (see PickingMode::GPU)
+    struct _Picking {
+        GLuint fbo{ 0 };
+        GLuint ids{ 0 };    // 1x1 GL_RGBA32UI: picking ID & relative UV
+        GLuint depth{ 0 };  // 1x1 depth buffer
+        GLuint pbo{ 0 };    // Readback of ids
+        GLsync fence{ nullptr };
+        // Planes & cameras of the pending pass, indexed by picking ID - 1
+        std::vector<std::weak_ptr<PlaneBase>> targets;
+        std::vector<std::weak_ptr<Camera>> cameras;
+    };
+    _Picking _picking;
+    PickingMode _picking_mode{ PickingMode::CPU };
+    // Draws picking IDs under the cursor & starts their readback
+    void _requestPicking(double x, double y);
+    // Updates the hovered model once the readback completed
+    void _resolvePicking();
+    void _releasePicking();
 
 public:
     /** Returns the last computed FPS.
@@ -457,6 +501,16 @@ public:
      *  Basically just calls glGet() with GL_MAX_TEXTURE_IMAGE_UNITS.
      */
     static inline uint32_t maxGLSLTextureUnits() noexcept { return _main._max_glsl_tex_units; };
+    /** Returns whether the driver supports given compressed texture
+     *  format (BC1, BC3, BC7, ETC2), as queried once via
+     *  glGetInternalformativ() when the main Window is created.
+     *  ETC2 is only reported when neither BC format is supported, as
+     *  desktop drivers tend to decompress it on upload.
+     */
+    static inline bool isCompressedFormatSupported(GLenum format) noexcept {
+        auto const& formats = _main._compressed_formats;
+        return std::find(formats.cbegin(), formats.cend(), format) != formats.cend();
+    };
 
     void emitEvent(const std::string& event_str) { EMIT_EVENT(event_str); };
 private:
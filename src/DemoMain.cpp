@@ -49,6 +49,7 @@ int main() try
     lua.safe_script_file("Init.lua");
     GL::Window& window = lua["window"];
     GL::PlaneRenderer& plane_renderer = lua["plane_renderer"];
+    GL::LineRenderer& line_renderer = lua["line_renderer"];
 
     Log::GL::Window::get().fps = true;
 
@@ -60,17 +61,15 @@ int main() try
         // xStepSize/yStepSize below and made the 0.02f step ~100x weaker than
         // intended (a near-flat, uniform-gray result). Neutralize it here.
         fnGenerator->SetScale(1.0f);
-        std::vector<float> noise(noise_w * noise_h);
-        fnGenerator->GenUniformGrid2D(noise.data(), 0, 0, noise_w, noise_h, 0.02f, 0.02f, 1337);
-
-        RGBA32::Vector pixels(noise.size());
-        for (size_t i = 0; i < noise.size(); ++i) {
-            uint8_t v = static_cast<uint8_t>(std::clamp((noise[i] * 0.5f + 0.5f) * 255.f, 0.f, 255.f));
-            pixels[i] = RGBA32(v, v, v, 255);
-        }
+        // Single-channel texture, generated & converted in place
+        std::vector<uint8_t> texels(noise_w * noise_h * sizeof(float));
+        float* noise = reinterpret_cast<float*>(texels.data());
+        fnGenerator->GenUniformGrid2D(noise, 0, 0, noise_w, noise_h, 0.02f, 0.02f, 1337);
+        GL::Texture::convertNoise(noise, noise_w * noise_h, GL_R8);
+        texels.resize(noise_w * noise_h);
 
         auto noise_texture = GL::Texture::create();
-        noise_texture->editRawPixels(pixels.data(), noise_w, noise_h);
+        noise_texture->editRawTexels(std::move(texels), noise_w, noise_h, GL_R8);
 
         auto noise_plane = GL::Plane::create(noise_texture);
         noise_plane->scale(300.f);
@@ -89,7 +88,8 @@ int main() try
 
     // Lines
     using Line = GL::Polyline;
-    Line::Shared line;
+    // Cursor-following curve, flattened & drawn anew every frame
+    Line::Vertex::Vec curve;
     //Line::Shared line[4];
     //line[0] = Line::Segment(glm::vec3(-200,  200, 0), glm::vec3( 200,  200, 0), 10.f, glm::vec4(0, 0, 1, 1), Line::JointType::BEVEL, Line::TermType::SQUARE);
     //line[1] = Line::Segment(glm::vec3( 200,  200, 0), glm::vec3( 200, -200, 0), 10.f, glm::vec4(0, 1, 0, 1), Line::JointType::BEVEL, Line::TermType::SQUARE);
@@ -111,7 +111,9 @@ int main() try
         if (window.keyIsPressed(GLFW_KEY_SPACE)) {
             LOG_MSG("SPACE")
         }
-        line = Line::Bezier(a, b, c, d, 20.f, glm::vec4(1, 1, 1, 1), Line::JointType::BEVEL, Line::TermType::SQUARE);
+        curve.clear();
+        Line::flattenBezier(a, b, c, d, Line::getBezierTolerance(), curve);
+        line_renderer.drawTransient(curve, 20.f, glm::vec4(1, 1, 1, 1), Line::JointType::BEVEL, Line::TermType::SQUARE);
         // Script
         lua.safe_script_file("Loop.lua");
         // Draw renderers
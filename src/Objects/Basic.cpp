@@ -5,6 +5,8 @@ SSS_GL_BEGIN;
 
 namespace Basic {
 
+    size_t Texture::_allocated_bytes{ 0 };
+
     Texture::Texture(GLenum given_target) try
         :   id([&]()->GLuint {
                 GLuint id;
@@ -18,6 +20,7 @@ namespace Basic {
 
     Texture::~Texture()
     {
+        _allocated_bytes -= _byte_size;
         glDeleteTextures(1, &id);
     }
 
@@ -28,19 +31,48 @@ namespace Basic {
 
     void Texture::setTarget(GLenum new_target) {
         _target = new_target;
+        _allocate();
+    }
+
+    void Texture::_allocate()
+    {
         bind();
+        bool const compressed = compressedSize(_internal_format, 1, 1) != 0;
+        GLsizei const compressed_size = compressedSize(_internal_format, _width, _height);
+        GLenum format, type;
+        GLsizei const texel_size = texelFormat(_internal_format, format, type);
+        _allocated_bytes -= _byte_size;
+        bool const layered = _target == GL_TEXTURE_2D_ARRAY || _target == GL_TEXTURE_3D;
+        _byte_size = static_cast<size_t>(layered ? _depth : 1) * (compressed
+            ? static_cast<size_t>(compressed_size)
+            : static_cast<size_t>(_width) * static_cast<size_t>(_height) * texel_size);
+        _allocated_bytes += _byte_size;
+        _released = false;
+        _released_bytes = 0;
         switch (_target)
         {
         case GL_TEXTURE_2D:
         case GL_TEXTURE_RECTANGLE:
-            glTexImage2D(_target, 0, GL_RGBA, _width, _height,
-                0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            if (compressed) {
+                glCompressedTexImage2D(_target, 0, _internal_format, _width, _height,
+                    0, compressed_size, nullptr);
+            }
+            else {
+                glTexImage2D(_target, 0, _internal_format, _width, _height,
+                    0, format, type, nullptr);
+            }
             break;
 
         case GL_TEXTURE_2D_ARRAY:
         case GL_TEXTURE_3D:
-            glTexImage3D(_target, 0, GL_RGBA, _width, _height, _depth,
-                0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            if (compressed) {
+                glCompressedTexImage3D(_target, 0, _internal_format, _width, _height, _depth,
+                    0, compressed_size * _depth, nullptr);
+            }
+            else {
+                glTexImage3D(_target, 0, _internal_format, _width, _height, _depth,
+                    0, format, type, nullptr);
+            }
             break;
 
         default:
@@ -54,43 +86,79 @@ namespace Basic {
         glTexParameteri(_target, pname, param);
     }
 
-    bool Texture::editSettings(int width, int height, int depth) try
+    bool Texture::editSettings(int width, int height, int depth, GLenum internal_format) try
     {
-        if (_width == width && _height == height && _depth == depth) {
+        if (_width == width && _height == height && _depth == depth
+            && _internal_format == internal_format)
+        {
+            if (_released)
+                _allocate();
             return false;
         }
 
-        bind();
-
         _width = width;
         _height = height;
         _depth = depth;
+        _internal_format = internal_format;
+        _allocate();
+
+        return true;
+    }
+    CATCH_AND_RETHROW_METHOD_EXC;
+
+    void Texture::editPixels(const GLvoid* pixels, int z_offset) try
+    {
+        if (pixels == nullptr) {
+            return;
+        }
+        bind();
+        GLenum format, type;
+        // R8 rows are tightly packed, and thus not always 4-byte aligned
+        GLint const alignment = texelFormat(_internal_format, format, type) == 1 ? 1 : 4;
+        glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
 
         switch (_target)
         {
         case GL_TEXTURE_2D:
         case GL_TEXTURE_RECTANGLE:
-            glTexImage2D(_target, 0, GL_RGBA, _width, _height,
-                0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            glTexSubImage2D(_target, 0, 0, 0, _width, _height,
+                format, type, pixels);
             break;
 
         case GL_TEXTURE_2D_ARRAY:
         case GL_TEXTURE_3D:
-            glTexImage3D(_target, 0, GL_RGBA, _width, _height, _depth,
-                0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            glTexSubImage3D(_target, 0, 0, 0, z_offset, _width, _height, 1,
+                format, type, pixels);
             break;
 
         default:
             throw_exc(METHOD_MSG("Given target is NOT handled by SSS/GL."));
         }
-
-        return true;
     }
     CATCH_AND_RETHROW_METHOD_EXC;
 
-    void Texture::editPixels(const GLvoid* pixels, int z_offset) try
+    void Texture::release()
     {
-        if (pixels == nullptr) {
+        if (_released) {
+            return;
+        }
+        // Allocate an empty storage, then restore settings
+        size_t const byte_size = _byte_size;
+        int const width = _width, height = _height, depth = _depth;
+        _width = 0;
+        _height = 0;
+        _depth = 0;
+        _allocate();
+        _width = width;
+        _height = height;
+        _depth = depth;
+        _released = true;
+        _released_bytes = byte_size;
+    }
+
+    void Texture::editCompressedPixels(const GLvoid* blocks, GLsizei size, int z_offset) try
+    {
+        if (blocks == nullptr) {
             return;
         }
         bind();
@@ -99,14 +167,14 @@ namespace Basic {
         {
         case GL_TEXTURE_2D:
         case GL_TEXTURE_RECTANGLE:
-            glTexSubImage2D(_target, 0, 0, 0, _width, _height,
-                GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+            glCompressedTexSubImage2D(_target, 0, 0, 0, _width, _height,
+                _internal_format, size, blocks);
             break;
 
         case GL_TEXTURE_2D_ARRAY:
         case GL_TEXTURE_3D:
-            glTexSubImage3D(_target, 0, 0, 0, z_offset, _width, _height, 1,
-                GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+            glCompressedTexSubImage3D(_target, 0, 0, 0, z_offset, _width, _height, 1,
+                _internal_format, size, blocks);
             break;
 
         default:
@@ -115,6 +183,46 @@ namespace Basic {
     }
     CATCH_AND_RETHROW_METHOD_EXC;
 
+    GLsizei Texture::compressedSize(GLenum format, int width, int height) noexcept
+    {
+        GLsizei block_bytes = 0;
+        switch (format)
+        {
+        case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RGB8_ETC2:
+            block_bytes = 8;
+            break;
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+        case GL_COMPRESSED_RGBA_BPTC_UNORM:
+        case GL_COMPRESSED_RGBA8_ETC2_EAC:
+            block_bytes = 16;
+            break;
+        default:
+            return 0;
+        }
+        // 4x4 texel blocks, partial blocks are padded
+        return ((width + 3) / 4) * ((height + 3) / 4) * block_bytes;
+    }
+
+    GLsizei Texture::texelFormat(GLenum internal_format, GLenum& format, GLenum& type) noexcept
+    {
+        switch (internal_format)
+        {
+        case GL_R8:
+            format = GL_RED;
+            type = GL_UNSIGNED_BYTE;
+            return 1;
+        case GL_R32F:
+            format = GL_RED;
+            type = GL_FLOAT;
+            return 4;
+        default:
+            format = GL_RGBA;
+            type = GL_UNSIGNED_BYTE;
+            return 4;
+        }
+    }
+
 
     VBO::VBO() try
         :   id([&]()->GLuint {
@@ -0,0 +1,80 @@
+#include "GL/Objects/Models/InstancedLine.hpp"
+
+SSS_GL_BEGIN;
+
+// The shader reads points as two vec4
+static_assert(sizeof(InstancedLine::Point) == 2 * sizeof(glm::vec4));
+
+std::vector<std::weak_ptr<InstancedLine>> InstancedLine::_batch{};
+uint64_t InstancedLine::_batch_version = 0;
+
+InstancedLine::InstancedLine(Point::Vec points, JointType jopt, TermType topt)
+    :   _points(std::move(points)),
+        _jopt(jopt),
+        _topt(topt)
+{
+    ++_batch_version;
+}
+
+InstancedLine::~InstancedLine()
+{
+    ++_batch_version;
+}
+
+InstancedLine::Shared InstancedLine::create(Point::Vec points, JointType jopt, TermType topt)
+{
+    Shared line(new InstancedLine(std::move(points), jopt, topt));
+    _batch.emplace_back(line);
+    return line;
+}
+
+InstancedLine::Shared InstancedLine::create(Polyline::Vertex::Vec const& path,
+    Math::Gradient<float> thickness, Math::Gradient<glm::vec4> color,
+    JointType jopt, TermType topt)
+{
+    Point::Vec points;
+    points.reserve(path.size());
+    for (size_t i = 0; i < path.size(); i++) {
+        //Parameter to define the emplacement in the gradient
+        float const t = path.size() > 1
+            ? static_cast<float>(i) / static_cast<float>(path.size() - 1) : 0.f;
+        points.emplace_back(path[i].v_pos, thickness.evaluate(t), color.evaluate(t));
+    }
+    return create(std::move(points), jopt, topt);
+}
+
+InstancedLine::Shared InstancedLine::create(Polyline::Vertex::Vec const& path,
+    float thickness, glm::vec4 color,
+    JointType jopt, TermType topt)
+{
+    Point::Vec points;
+    points.reserve(path.size());
+    for (Polyline::Vertex const& vertex : path) {
+        points.emplace_back(vertex.v_pos, thickness, color);
+    }
+    return create(std::move(points), jopt, topt);
+}
+
+void InstancedLine::setPoints(Point::Vec points)
+{
+    _points = std::move(points);
+    ++_batch_version;
+}
+
+void InstancedLine::setJointType(JointType jopt)
+{
+    if (_jopt != jopt) {
+        _jopt = jopt;
+        ++_batch_version;
+    }
+}
+
+void InstancedLine::setTermType(TermType topt)
+{
+    if (_topt != topt) {
+        _topt = topt;
+        ++_batch_version;
+    }
+}
+
+SSS_GL_END;
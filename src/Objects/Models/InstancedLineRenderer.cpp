@@ -0,0 +1,115 @@
+#include "GL/Objects/Models/InstancedLineRenderer.hpp"
+#include "GL/Window.hpp"
+
+SSS_GL_BEGIN;
+
+InstancedLineRenderer::InstancedLineRenderer()
+{
+    auto shader = Window::getPresetShaders(static_cast<uint32_t>(Shaders::Preset::InstancedLine));
+    addMaterial("default", Material(shader));
+
+    _vao.setup([this]() {
+        _segments.bind();
+        //Point indices
+        glEnableVertexAttribArray(0);
+        glVertexAttribIPointer(0, 4, GL_UNSIGNED_INT,
+            sizeof(_Segment), (void*)0);
+        glVertexAttribDivisor(0, 1);
+        //Joint & terminaison styles
+        glEnableVertexAttribArray(1);
+        glVertexAttribIPointer(1, 1, GL_UNSIGNED_INT,
+            sizeof(_Segment), (void*)(sizeof(glm::uvec4)));
+        glVertexAttribDivisor(1, 1);
+    });
+
+    _vao.unbind();
+}
+
+void InstancedLineRenderer::_rebuild()
+{
+    // Prune expired lines
+    std::erase_if(InstancedLine::_batch, [](std::weak_ptr<InstancedLine> const& line) {
+        return line.expired();
+    });
+
+    InstancedLine::Point::Vec points;
+    std::vector<_Segment> segments;
+    for (std::weak_ptr<InstancedLine> const& weak : InstancedLine::_batch) {
+        InstancedLine::Shared const line = weak.lock();
+        if (!line) {
+            continue;
+        }
+        // Consecutive duplicates would give null segments
+        uint32_t const first = static_cast<uint32_t>(points.size());
+        for (InstancedLine::Point const& point : line->_points) {
+            if (points.size() == first || points.back().position != point.position)
+                points.push_back(point);
+        }
+        if (line->_topt == InstancedLine::TermType::CONNECT && points.size() - first > 1
+            && points.back().position == points[first].position)
+            points.pop_back();
+        uint32_t const count = static_cast<uint32_t>(points.size()) - first;
+        if (count < 2) {
+            points.resize(first);
+            continue;
+        }
+
+        bool const closed = line->_topt == InstancedLine::TermType::CONNECT && count >= 3;
+        uint32_t const joint = static_cast<uint32_t>(line->_jopt);
+        // Unclosed CONNECT lines are drawn with BUTT terminaisons
+        uint32_t const term = static_cast<uint32_t>(
+            line->_topt == InstancedLine::TermType::CONNECT
+            ? InstancedLine::TermType::BUTT : line->_topt);
+        uint32_t const segment_count = closed ? count : count - 1;
+        for (uint32_t i = 0; i < segment_count; ++i) {
+            uint32_t const a = first + i;
+            uint32_t const b = first + (i + 1) % count;
+            bool const has_prev = closed || i != 0;
+            bool const has_next = closed || i + 1 != segment_count;
+            uint32_t const prev = has_prev ? first + (i + count - 1) % count : a;
+            uint32_t const next = has_next ? first + (i + 2) % count : b;
+            uint32_t const style = joint | term << 2
+                | static_cast<uint32_t>(has_prev) << 4
+                | static_cast<uint32_t>(has_next) << 5;
+            segments.push_back({ glm::uvec4(prev, a, b, next), style });
+        }
+    }
+
+    // Empty buffers can't be bound
+    if (points.empty())
+        points.emplace_back();
+    _points.edit(points.size() * sizeof(InstancedLine::Point), points.data(), GL_DYNAMIC_DRAW);
+    _segments.edit(segments.size() * sizeof(_Segment), segments.data(), GL_DYNAMIC_DRAW);
+    _segment_count = static_cast<GLsizei>(segments.size());
+}
+
+void InstancedLineRenderer::render()
+{
+    if (!isActive()) {
+        return;
+    }
+
+    _vao.bind();
+
+    // Points are uploaded as is, only segment indices are generated
+    if (_batch_version != InstancedLine::_batch_version) {
+        _rebuild();
+        _batch_version = InstancedLine::_batch_version;
+    }
+
+    Material mat = swapMaterial("default");
+    mat.set("u_MVP", camera ? camera->getVP() : glm::mat4(1));
+    // Anti-aliasing fringes are sized in pixels
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    mat.set("u_Viewport", glm::vec2(viewport[2], viewport[3]));
+
+    if (_segment_count != 0) {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, _points.id);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, _segment_count);
+    }
+
+    _vao.unbind();
+}
+
+SSS_GL_END;
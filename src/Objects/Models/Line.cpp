@@ -1,5 +1,7 @@
 #include "GL/Objects/Models/Line.hpp"
 
+#include <execution>
+
 SSS_GL_BEGIN;
 
 static constexpr glm::vec4 fade = glm::vec4(1, 1, 1, 0);
@@ -8,15 +10,20 @@ static constexpr double MAX_MITER_ANGLE = M_PI * 0.75;
 static constexpr double MINIMUM_BEVEL_ANGLE = M_PI / 18;
 
 std::vector<std::weak_ptr<Polyline>> Polyline::_batch{};
-bool Polyline::modified = true;
+uint64_t Polyline::batch_version = 0;
 uint32_t Polyline::max_depth = 2;
+float Polyline::bezier_tolerance = 0.25f;
+float Polyline::bezier_scale = 1.f;
+float Polyline::bezier_frame_scale = 0.f;
+bool Polyline::bezier_dirty = false;
+std::vector<Polyline::_PendingBatch> Polyline::_pending_batches{};
 
 
 Polyline::Polyline(Vertex::Vec _path,
     Math::Gradient<float> gradient_thickness,
     Math::Gradient<glm::vec4> gradient_color,
     JointType jopt, TermType topt)
-    :   path(_path),
+    :   path(std::move(_path)),
         g_thick(gradient_thickness),
         g_col(gradient_color),
         _jopt(jopt),
@@ -25,14 +32,24 @@ Polyline::Polyline(Vertex::Vec _path,
     //Select the largest element in the gradient to define the antialliasing/feathering width
     _aa_thickness = define_aa_thickness(gradient_thickness.max());
     path_meshing(gradient_thickness, gradient_color, jopt, topt);
+    mesh_version = ++batch_version;
+}
 
-    modified = true;
+Polyline::Polyline(Params&& params)
+    :   path(std::move(params.path)),
+        g_thick(std::move(params.thickness)),
+        g_col(std::move(params.color)),
+        _jopt(params.jopt),
+        _topt(params.topt)
+{
+    _aa_thickness = define_aa_thickness(g_thick.max());
+    path_meshing(g_thick, g_col, _jopt, _topt);
 }
 
 
 Polyline::~Polyline()
 {
-    modified = true;
+    ++batch_version;
 
     mesh.clear();
     path.clear();
@@ -43,10 +60,99 @@ Polyline::~Polyline()
 uint32_t Polyline::update(Math::Gradient<float> gradient_thickness, Math::Gradient<glm::vec4> gradient_color)
 {
     path_meshing(gradient_thickness, gradient_color, _jopt, _topt);
+    mesh_version = ++batch_version;
 
     return 0;
 }
 
+void Polyline::appendPoints(Vertex::Vec const& points)
+{
+    if (points.empty()) {
+        return;
+    }
+    // The path no longer follows the Bezier curve
+    _bezier.reset();
+    // The previous last point becomes a joint
+    size_t first = path.size() - 1;
+    if (_topt == TermType::CONNECT || mesh.empty()) {
+        path.resize(path.size() - _closing_points);
+        _closing_points = 0;
+        first = 0;
+    }
+    path.insert(path.end(), points.begin(), points.end());
+    path_meshing(g_thick, g_col, _jopt, _topt, first);
+    mesh_version = ++batch_version;
+}
+
+std::vector<Polyline::Shared> Polyline::Batch(std::vector<Params> params)
+{
+    std::vector<Shared> lines = _meshBatch(std::move(params));
+    _publish(lines);
+    return lines;
+}
+
+void Polyline::BatchAsync(std::vector<Params> params,
+    std::function<void(std::vector<Shared> const&)> callback)
+{
+    _PendingBatch batch;
+    batch.lines = std::async(std::launch::async, [params = std::move(params)]() mutable {
+        return _meshBatch(std::move(params));
+    });
+    batch.callback = std::move(callback);
+    _pending_batches.push_back(std::move(batch));
+}
+
+std::vector<Polyline::Shared> Polyline::_meshBatch(std::vector<Params>&& params)
+{
+    std::vector<Shared> lines(params.size());
+    std::transform(std::execution::par, params.begin(), params.end(), lines.begin(),
+        [](Params& line_params) {
+            return Shared(new Polyline(std::move(line_params)));
+        });
+    return lines;
+}
+
+void Polyline::_publish(std::vector<Shared> const& lines)
+{
+    _batch.reserve(_batch.size() + lines.size());
+    for (Shared const& line : lines) {
+        line->mesh_version = ++batch_version;
+        _batch.emplace_back(line);
+    }
+}
+
+void Polyline::_meshTransient(Vertex::Vec const& new_path,
+    Math::Gradient<float> const& thickness, Math::Gradient<glm::vec4> const& color,
+    JointType jopt, TermType topt)
+{
+    //Assigned to keep the capacity of previous paths
+    path.assign(new_path.begin(), new_path.end());
+    _closing_points = 0;
+    g_thick = thickness;
+    g_col = color;
+    _jopt = jopt;
+    _topt = topt;
+    _aa_thickness = define_aa_thickness(g_thick.max());
+    path_meshing(g_thick, g_col, _jopt, _topt);
+}
+
+void Polyline::_pollBatches()
+{
+    // Batches are published in the order they were given
+    while (!_pending_batches.empty()) {
+        if (_pending_batches.front().lines.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            break;
+        // Removed before get(), which rethrows meshing exceptions
+        _PendingBatch batch = std::move(_pending_batches.front());
+        _pending_batches.erase(_pending_batches.begin());
+        std::vector<Shared> const lines = batch.lines.get();
+        auto const& callback = batch.callback;
+        _publish(lines);
+        if (callback)
+            callback(lines);
+    }
+}
+
 
 
 Polyline::Shared Polyline::Line(Vertex::Vec path,
@@ -119,25 +225,13 @@ Polyline::Shared Polyline::Bezier(glm::vec3 a, glm::vec3 b, glm::vec3 c, glm::ve
     Math::Gradient<float> thickness, Math::Gradient<glm::vec4> color,
     JointType jopt, TermType topt)
 {
+    uint32_t const segments = _bezierSegments(a, b, c, d, bezier_tolerance / bezier_scale);
     Vertex::Vec path;
-    std::vector<std::pair<float, glm::vec3>> v;
-    v.emplace_back(std::make_pair(0.f, a));
-    v.emplace_back(std::make_pair(0.5f, Math::bezier_func(0.5f, a, b, c, d)));
-    v.emplace_back(std::make_pair(1.f, d));
-
-    Math::bezier_recurs(v, v[0], v[1], a, b, c, d);
-    Math::bezier_recurs(v, v[1], v[2], a, b, c, d);
+    _flattenBezier(a, b, c, d, segments, path);
 
-    std::sort(v.begin(), v.end(), Math::sort_pair_vec);
-    path.reserve(v.size());
-
-    for (auto p : v) {
-        path.emplace_back(p.second);
-    }
-
-    Shared line(new Polyline(path, thickness, color, jopt, topt));
+    Shared line(new Polyline(std::move(path), thickness, color, jopt, topt));
+    line->_bezier = _Bezier{ a, b, c, d, segments };
     _batch.emplace_back(line);
-    path.clear();
 
     return line;
 }
@@ -152,7 +246,91 @@ Polyline::Shared Polyline::Bezier(glm::vec3 a, glm::vec3 b, glm::vec3 c, glm::ve
     Math::Gradient<glm::vec4> g_color;
     g_color.push(std::make_pair(0.0f, color));
 
-    return Bezier(a, b, c, d, g_thickness, g_color);
+    return Bezier(a, b, c, d, g_thickness, g_color, jopt, topt);
+}
+
+void Polyline::setBezierTolerance(float pixels) noexcept
+{
+    bezier_tolerance = std::max(pixels, 0.001f);
+    // Forces the next _flattenBeziers() call to check every line
+    bezier_dirty = true;
+}
+
+void Polyline::flattenBezier(glm::vec3 a, glm::vec3 b, glm::vec3 c, glm::vec3 d,
+    float tolerance, Vertex::Vec& path)
+{
+    _flattenBezier(a, b, c, d, _bezierSegments(a, b, c, d, tolerance), path);
+}
+
+uint32_t Polyline::_bezierSegments(glm::vec3 a, glm::vec3 b, glm::vec3 c, glm::vec3 d,
+    float tolerance) noexcept
+{
+    //Wang's formula: n = sqrt(degree * (degree - 1) / 8 * max|second differences| / tolerance)
+    float const m = std::max(glm::length(a - 2.f * b + c), glm::length(b - 2.f * c + d));
+    float const n = std::ceil(std::sqrt(0.75f * m / std::max(tolerance, 1e-6f)));
+    //Clamped, as a degenerate tolerance would give an absurd count
+    return static_cast<uint32_t>(std::clamp(n, 1.f, 4096.f));
+}
+
+void Polyline::_flattenBezier(glm::vec3 a, glm::vec3 b, glm::vec3 c, glm::vec3 d,
+    uint32_t segments, Vertex::Vec& path)
+{
+    //Polynomial coefficients: p(t) = k3 t^3 + k2 t^2 + k1 t + a
+    glm::vec3 const k1 = 3.f * (b - a);
+    glm::vec3 const k2 = 3.f * (a - 2.f * b + c);
+    glm::vec3 const k3 = d - a + 3.f * (b - c);
+
+    //Forward differences for a constant step
+    float const h = 1.f / static_cast<float>(segments);
+    float const h2 = h * h, h3 = h2 * h;
+    glm::vec3 point = a;
+    glm::vec3 d1 = k3 * h3 + k2 * h2 + k1 * h;
+    glm::vec3 d2 = 6.f * k3 * h3 + 2.f * k2 * h2;
+    glm::vec3 const d3 = 6.f * k3 * h3;
+
+    path.reserve(path.size() + segments + 1);
+    path.emplace_back(a);
+    for (uint32_t i = 1; i < segments; i++) {
+        point += d1;
+        d1 += d2;
+        d2 += d3;
+        path.emplace_back(point);
+    }
+    //Exact end point, regardless of accumulated errors
+    path.emplace_back(d);
+}
+
+void Polyline::_flattenBeziers()
+{
+    // Lines are shared by all renderers, the closest camera needs the finest ones
+    float const scale = bezier_frame_scale;
+    bezier_frame_scale = 0.f;
+    if (scale <= 0.f || (scale == bezier_scale && !bezier_dirty)) {
+        return;
+    }
+    bezier_scale = scale;
+    bezier_dirty = false;
+    float const tolerance = bezier_tolerance / scale;
+
+    for (std::weak_ptr<Polyline> const& weak : _batch) {
+        Shared const line = weak.lock();
+        if (!line || !line->_bezier) {
+            continue;
+        }
+        _Bezier& bezier = *line->_bezier;
+        uint32_t const segments = _bezierSegments(bezier.a, bezier.b, bezier.c, bezier.d, tolerance);
+        //Refine when the error bound is exceeded, only coarsen when twice as fine as needed
+        if (segments <= bezier.segments && segments * 2 > bezier.segments) {
+            continue;
+        }
+        bezier.segments = segments;
+        //The path keeps its capacity
+        line->path.clear();
+        line->_closing_points = 0;
+        _flattenBezier(bezier.a, bezier.b, bezier.c, bezier.d, segments, line->path);
+        line->path_meshing(line->g_thick, line->g_col, line->_jopt, line->_topt);
+        line->mesh_version = ++batch_version;
+    }
 }
 
 Polyline::Mesh_info::Mesh_info() :
@@ -160,12 +338,12 @@ Polyline::Mesh_info::Mesh_info() :
 {
 }
 
-Polyline::Mesh_info::Mesh_info(uint16_t t, uint16_t b, uint16_t aat, uint16_t aab) :
+Polyline::Mesh_info::Mesh_info(uint32_t t, uint32_t b, uint32_t aat, uint32_t aab) :
     top(t), btm(b), aa_top(aat), aa_btm(aab)
 {
 }
 
-void Polyline::Mesh_info::update(uint16_t t, uint16_t b, uint16_t aat, uint16_t aab)
+void Polyline::Mesh_info::update(uint32_t t, uint32_t b, uint32_t aat, uint32_t aab)
 {
     top = t;
     btm = b;
@@ -201,16 +379,31 @@ uint8_t Polyline::quad_index(uint32_t lft_top, uint32_t lft_btm, uint32_t rgt_bt
     return 0;
 }
 
-uint8_t Polyline::path_meshing(Math::Gradient<float> gradient_thickness, Math::Gradient<glm::vec4> gradient_color, JointType jopt, TermType topt)
+uint8_t Polyline::path_meshing(Math::Gradient<float> gradient_thickness, Math::Gradient<glm::vec4> gradient_color, JointType jopt, TermType topt, size_t first)
 {
-    if (path.size() < 2) {
-        return 1;
-    }
-
     Mesh_info mesh_last;
 
     glm::vec3 ortho = glm::vec3(0);
 
+    if (first == 0) {
+        //Closing points are added back by connect_ending()
+        path.resize(path.size() - _closing_points);
+        _closing_points = 0;
+        mesh.clear();
+        indices.clear();
+    }
+    else {
+        //Drop the last terminaison and resume from the point before it
+        mesh.resize(_tail.mesh_size);
+        indices.resize(_tail.indices_size);
+        mesh_last = _tail.last;
+        ortho = _tail.ortho;
+    }
+
+    if (path.size() < 2) {
+        return 1;
+    }
+
     JointFunc joint_type_func;
     switch (jopt) {
     case JointType::MITER:
@@ -244,27 +437,50 @@ uint8_t Polyline::path_meshing(Math::Gradient<float> gradient_thickness, Math::G
         throw std::exception("Unhandled TermType");
     }
 
-    float m_thickness = 0;
-    for (size_t i = 0; i < path.size(); i++) {
-        glm::vec4 color = glm::vec4(0, 0, 0, 1);
+    //Gradients are evaluated in a single pass over the path parameters,
+    //into per-thread arrays reused by every meshing.
+    //connect_ending() adds 2 points to the path, spreading gradients further.
+    static thread_local std::vector<float> thicknesses;
+    static thread_local std::vector<glm::vec4> colors;
+    size_t const count = path.size() + (topt == TermType::CONNECT && first == 0 ? 2 : 0);
+    thicknesses.resize(count);
+    colors.resize(count);
+    float const last_index = static_cast<float>(count - 1);
+    for (size_t i = first; i < count; i++) {
         //Parameter to define the emplacement in the gradient
-        float t = static_cast<float>(i) / static_cast<float>(path.size() - 1);
+        float const t = static_cast<float>(i) / last_index;
+        thicknesses[i] = define_line_thickness(g_thick.evaluate(t));
+        colors[i] = g_col.evaluate(t);
+    }
+
+    size_t const mesh_begin = mesh.size();
+    for (size_t i = first; i < path.size(); i++) {
+        if (i + 1 == path.size()) {
+            _tail = { mesh.size(), indices.size(), mesh_last, ortho };
+        }
 
         if (i == 0 || i + 1 == path.size()) {
             //Line terminaison for first and last point
-            (this->*term_type_func)(static_cast<uint32_t>(i), mesh_last, ortho, define_line_thickness(g_thick.evaluate(t)), g_col.evaluate(t));
+            (this->*term_type_func)(static_cast<uint32_t>(i), mesh_last, ortho, thicknesses[i], colors[i]);
         }
         else {
             //Meshing along the line
-            (this->*joint_type_func)(static_cast<uint32_t>(i), mesh_last, ortho, define_line_thickness(g_thick.evaluate(t)), g_col.evaluate(t), 0);
+            (this->*joint_type_func)(static_cast<uint32_t>(i), mesh_last, ortho, thicknesses[i], colors[i], 0);
         }
     }
 
+    //Appended vertices extend the previous bounds
+    if (mesh_begin == 0) {
+        _bounds_min = glm::vec3(std::numeric_limits<float>::max());
+        _bounds_max = glm::vec3(std::numeric_limits<float>::lowest());
+    }
     // TODO: Fix la 3D quand on aura le temps et que ça sera nécessaire
     // Normalize Z
     float const z = path.at(0).v_pos.z;
-    for (Vertex& v : mesh) {
-        v.v_pos.z = z;
+    for (size_t i = mesh_begin; i < mesh.size(); i++) {
+        mesh[i].v_pos.z = z;
+        _bounds_min = glm::min(_bounds_min, mesh[i].v_pos);
+        _bounds_max = glm::max(_bounds_max, mesh[i].v_pos);
     }
     return 0;
 }
@@ -456,6 +672,7 @@ uint8_t Polyline::connect_ending(uint32_t index, Mesh_info& last,
         path.reserve(path.size() + 2);
         path.emplace_back(pos, color);
         path.emplace_back(path[static_cast<size_t>(index) + 1].v_pos, color);
+        _closing_points = 2;
 
         mesh.reserve(mesh.size() + 4);
         mesh.emplace_back(pos, color);
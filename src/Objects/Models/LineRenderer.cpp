@@ -1,122 +1,371 @@
 #include "GL/Objects/Models/LineRenderer.hpp"
 #include "GL/Window.hpp"
 
+#include <unordered_map>
+#include <glm/gtc/packing.hpp>
+
 SSS_GL_BEGIN;
 
+static void setupVertexAttributes()
+{
+    //Coordinates
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3,
+        GL_FLOAT, GL_FALSE,
+        sizeof(Polyline::Vertex), (void*)0);
+    //Colors
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 4,
+        GL_FLOAT, GL_FALSE,
+        sizeof(Polyline::Vertex),
+        (void*)(sizeof(glm::vec3)));
+}
+
 LineRenderer::LineRenderer()
 {
     auto shader = Window::getPresetShaders(static_cast<uint32_t>(Shaders::Preset::Line));
     addMaterial("default", Material(shader));
 
+    _setupVAO();
+    _transient_vao.setup([this]() {
+        _transient_vbo.bind();
+        _transient_ibo.bind();
+        setupVertexAttributes();
+    });
+
+    _vao.unbind();
+}
+
+void LineRenderer::_setupVAO()
+{
     _vao.setup([this]() {
         _vbo.bind();
         _ibo.bind();
+        if (_vertex_format == VertexFormat::Full) {
+            setupVertexAttributes();
+            glDisableVertexAttribArray(2);
+            return;
+        }
         //Coordinates
         glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3,
+        glVertexAttribPointer(0, 2,
             GL_FLOAT, GL_FALSE,
-            sizeof(Polyline::Vertex), (void*)0);
-        //Colors
+            sizeof(_PackedVertex), (void*)0);
+        //Colors, normalized
         glEnableVertexAttribArray(1);
         glVertexAttribPointer(1, 4,
+            GL_UNSIGNED_BYTE, GL_TRUE,
+            sizeof(_PackedVertex),
+            (void*)(sizeof(glm::vec2)));
+        //Line z, one per draw command
+        _lines_z_vbo.bind();
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 1,
             GL_FLOAT, GL_FALSE,
-            sizeof(Polyline::Vertex),
-            (void*)(sizeof(glm::vec3)));
+            sizeof(float), (void*)0);
+        glVertexAttribDivisor(2, 1);
     });
+}
 
+size_t LineRenderer::_vertexSize() const noexcept
+{
+    return _vertex_format == VertexFormat::Packed ? sizeof(_PackedVertex) : sizeof(Polyline::Vertex);
+}
+
+void LineRenderer::setVertexFormat(VertexFormat format)
+{
+    if (_vertex_format == format) {
+        return;
+    }
+    _vertex_format = format;
+    _setupVAO();
     _vao.unbind();
+
+    // Every line gets a new slot, in buffers reallocated by the next sync
+    _slots.clear();
+    _vertex_end = 0;
+    _index_end = 0;
+    _vertex_capacity = 0;
+    _index_capacity = 0;
+    // Differs from any version, forcing the next render() to sync
+    _batch_version = Polyline::batch_version - 1;
 }
 
-void LineRenderer::gen_batch(Polyline::Vertex::Vec& mesh, Polyline::Indices::Vec& indices)
+void LineRenderer::drawTransient(Polyline::Vertex::Vec const& path,
+    Math::Gradient<float> const& thickness, Math::Gradient<glm::vec4> const& color,
+    Polyline::JointType jopt, Polyline::TermType topt)
 {
-    size_t indice_size = 0, mesh_size = 0, offset = 0;
+    if (!_transient_line) {
+        _transient_line.reset(new Polyline(Polyline::Params{ {}, thickness, color, jopt, topt }));
+    }
+    Polyline& line = *_transient_line;
+    line._meshTransient(path, thickness, color, jopt, topt);
+
+    // Indices are rebased on the arena
+    uint32_t const base = static_cast<uint32_t>(_transient_vertices.size());
+    _transient_vertices.insert(_transient_vertices.end(), line.mesh.begin(), line.mesh.end());
+    _transient_indices.reserve(_transient_indices.size() + line.indices.size());
+    for (Polyline::Indices const& triangle : line.indices) {
+        _transient_indices.emplace_back(triangle._uc + base, triangle._bc + base, triangle._sc + base);
+    }
+}
 
-    //std::sort(Polyline::_batch.begin(), Polyline::_batch.end(), Polyline::sort);
+void LineRenderer::drawTransient(Polyline::Vertex::Vec const& path,
+    float thickness, glm::vec4 color,
+    Polyline::JointType jopt, Polyline::TermType topt)
+{
+    Math::Gradient<float> g_thickness;
+    g_thickness.push(std::make_pair(0.0f, thickness));
 
-    //Check if the lines pointer are expired and set the necessary reserve size for the batch
-    for (std::weak_ptr<Polyline> arrow_weak : Polyline::_batch) {
+    Math::Gradient<glm::vec4> g_color;
+    g_color.push(std::make_pair(0.0f, color));
 
-        Polyline::Shared const arrow = arrow_weak.lock();
-        if (!arrow) {
-            continue;
-        }
+    drawTransient(path, g_thickness, g_color, jopt, topt);
+}
 
-        indice_size += arrow->indices.size();
-        mesh_size += arrow->mesh.size();
+void LineRenderer::_syncBatch()
+{
+    // Prune expired lines
+    std::erase_if(Polyline::_batch, [](std::weak_ptr<Polyline> const& line) {
+        return line.expired();
+    });
+
+    // Slots are matched by address. A new line reusing the address of a
+    // destroyed one simply takes over its slot, as versions are unique.
+    std::unordered_map<Polyline const*, size_t> previous;
+    previous.reserve(_slots.size());
+    for (size_t i = 0; i < _slots.size(); ++i) {
+        previous.emplace(_slots[i].ptr, i);
     }
 
-    indices.reserve(indice_size);
-    mesh.reserve(mesh_size);
+    std::vector<_Slot> slots;
+    slots.reserve(Polyline::_batch.size());
+    uint32_t live_vertices = 0;
+    bool overflow = false;
+    for (std::weak_ptr<Polyline> const& weak : Polyline::_batch) {
+        Polyline::Shared const line = weak.lock();
+        if (!line) {
+            continue;
+        }
+        _Slot slot;
+        if (auto const it = previous.find(line.get()); it != previous.end())
+            slot = _slots[it->second];
+        slot.line = weak;
+        slot.ptr = line.get();
+
+        uint32_t const vertex_count = static_cast<uint32_t>(line->mesh.size());
+        uint32_t const index_count = static_cast<uint32_t>(line->indices.size());
+        live_vertices += vertex_count;
+        if (slot.version != line->mesh_version) {
+            // Outgrown slots are moved to the end of the buffers
+            if (vertex_count > slot.vertex_capacity || index_count > slot.index_capacity) {
+                slot.first_vertex = _vertex_end;
+                slot.vertex_capacity = vertex_count;
+                _vertex_end += vertex_count;
+                slot.first_index = _index_end;
+                slot.index_capacity = index_count;
+                _index_end += index_count;
+            }
+            slot.vertex_count = vertex_count;
+            slot.index_count = index_count;
+            slot.version = line->mesh_version;
+            slot.bounds_min = line->_bounds_min;
+            slot.bounds_max = line->_bounds_max;
+            // Written by _compact() below if buffers are full
+            if (_vertex_end <= _vertex_capacity && _index_end <= _index_capacity)
+                _write(slot, *line);
+            else
+                overflow = true;
+        }
+        slots.push_back(std::move(slot));
+    }
+    _slots = std::move(slots);
 
+    // Repack when buffers are full, or mostly wasted by moved & removed lines
+    static constexpr uint32_t min_waste = 4096;
+    uint32_t const waste = _vertex_end - live_vertices;
+    if (overflow || (waste > min_waste && waste > live_vertices)) {
+        _compact();
+    }
+}
 
-    Polyline::Indices tmp;
+// Whether the box is entirely outside of one of the clip volume planes
+static bool isOutside(glm::mat4 const& vp, glm::vec3 const& min, glm::vec3 const& max)
+{
+    glm::vec4 corners[8];
+    for (int i = 0; i < 8; ++i) {
+        corners[i] = vp * glm::vec4(
+            (i & 1) ? max.x : min.x,
+            (i & 2) ? max.y : min.y,
+            (i & 4) ? max.z : min.z, 1.f);
+    }
+    for (int axis = 0; axis < 3; ++axis) {
+        bool below = true, above = true;
+        for (glm::vec4 const& corner : corners) {
+            below = below && corner[axis] < -corner.w;
+            above = above && corner[axis] > corner.w;
+        }
+        if (below || above)
+            return true;
+    }
+    return false;
+}
 
-    //Add the vertices and indices in the batch    
-    for (std::weak_ptr<Polyline> const& arrow_weak : Polyline::_batch) {
-        
-        Polyline::Shared const arrow = arrow_weak.lock();
-        if (!arrow) {
+void LineRenderer::_buildDrawList(glm::mat4 const& vp)
+{
+    _visible.clear();
+    for (_Slot const& slot : _slots) {
+        if (slot.index_count == 0 || isOutside(vp, slot.bounds_min, slot.bounds_max))
             continue;
+        float depth = 0.f;
+        if (_depth_sorting) {
+            glm::vec4 const center = vp * glm::vec4((slot.bounds_min + slot.bounds_max) * 0.5f, 1.f);
+            depth = center.z / center.w;
         }
+        _visible.emplace_back(depth, &slot);
+    }
+    // Farthest first, stable to keep the batch order between equal depths
+    if (_depth_sorting) {
+        std::stable_sort(_visible.begin(), _visible.end(),
+            [](auto const& a, auto const& b) { return a.first > b.first; });
+    }
 
-        //Create the batch indices
-        for (Polyline::Indices const& t : arrow->indices) {
-            tmp = t;
-            tmp._bc += static_cast<uint32_t>(offset);
-            tmp._sc += static_cast<uint32_t>(offset);
-            tmp._uc += static_cast<uint32_t>(offset);
-
-            indices.emplace_back(tmp);
+    if (_vertex_format == VertexFormat::Packed) {
+        _commands.clear();
+        _lines_z.clear();
+        for (auto const& [depth, slot] : _visible) {
+            _commands.push_back({ 3 * slot->index_count, 1, 3 * slot->first_index,
+                static_cast<GLint>(slot->first_vertex), static_cast<GLuint>(_lines_z.size()) });
+            // Meshes are flat, see Polyline::path_meshing()
+            _lines_z.push_back(slot->bounds_min.z);
         }
+        return;
+    }
 
-        offset += arrow->mesh.size();
+    _counts.clear();
+    _offsets.clear();
+    _base_vertices.clear();
+    for (auto const& [depth, slot] : _visible) {
+        _counts.push_back(3 * static_cast<GLsizei>(slot->index_count));
+        _offsets.push_back(reinterpret_cast<void const*>(
+            static_cast<uintptr_t>(slot->first_index) * sizeof(Polyline::Indices)));
+        _base_vertices.push_back(static_cast<GLint>(slot->first_vertex));
+    }
+}
 
-        //batch the vertices
-        mesh.insert(mesh.end(), arrow->mesh.begin(), arrow->mesh.end());
+void LineRenderer::_compact()
+{
+    uint32_t vertices = 0, indices = 0;
+    for (_Slot const& slot : _slots) {
+        vertices += slot.vertex_count;
+        indices += slot.index_count;
+    }
+    // Leave room for lines to be added or to grow without repacking
+    _vertex_capacity = std::max(vertices + vertices / 2, 1024u);
+    _index_capacity = std::max(indices + indices / 2, 1024u);
+    _vbo.edit(_vertex_capacity * _vertexSize(), nullptr, GL_DYNAMIC_DRAW);
+    _ibo.edit(_index_capacity * sizeof(Polyline::Indices), nullptr, GL_DYNAMIC_DRAW);
+
+    _vertex_end = 0;
+    _index_end = 0;
+    for (_Slot& slot : _slots) {
+        slot.first_vertex = _vertex_end;
+        slot.vertex_capacity = slot.vertex_count;
+        _vertex_end += slot.vertex_count;
+        slot.first_index = _index_end;
+        slot.index_capacity = slot.index_count;
+        _index_end += slot.index_count;
+        if (Polyline::Shared const line = slot.line.lock())
+            _write(slot, *line);
     }
+}
 
+void LineRenderer::_write(_Slot const& slot, Polyline const& line)
+{
+    if (slot.vertex_count != 0) {
+        void const* data = line.mesh.data();
+        if (_vertex_format == VertexFormat::Packed) {
+            _packed.clear();
+            _packed.reserve(line.mesh.size());
+            for (Polyline::Vertex const& vertex : line.mesh) {
+                _packed.push_back({ glm::vec2(vertex.v_pos), glm::packUnorm4x8(vertex.v_color) });
+            }
+            data = _packed.data();
+        }
+        size_t const vertex_size = _vertexSize();
+        _vbo.bind();
+        glBufferSubData(GL_ARRAY_BUFFER,
+            static_cast<GLintptr>(slot.first_vertex) * vertex_size,
+            static_cast<GLsizeiptr>(slot.vertex_count) * vertex_size,
+            data);
+    }
+    if (slot.index_count != 0) {
+        _ibo.bind();
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER,
+            static_cast<GLintptr>(slot.first_index) * sizeof(Polyline::Indices),
+            static_cast<GLsizeiptr>(slot.index_count) * sizeof(Polyline::Indices),
+            line.indices.data());
+    }
 }
 
 void LineRenderer::render()
 {
     if (!isActive()) {
+        _transient_vertices.clear();
+        _transient_indices.clear();
         return;
     }
 
-    static size_t size;
-
     _vao.bind();
 
-    if (Polyline::modified) {
-
-        Polyline::Vertex::Vec tmp_v;
-        Polyline::Indices::Vec tmp_i;
-
-        gen_batch(tmp_v, tmp_i);
-
-        _vbo.edit(
-            tmp_v.size() * sizeof(Polyline::Vertex),
-            tmp_v.data(),
-            GL_STATIC_DRAW
-        );
+    // Bezier lines follow the highest camera zoom, see pollEverything()
+    Polyline::bezier_frame_scale = std::max(Polyline::bezier_frame_scale,
+        camera ? camera->getZoom() : 1.f);
 
-        _ibo.edit(
-            tmp_i.size() * sizeof(Polyline::Indices),
-            tmp_i.data(),
-            GL_STATIC_DRAW);
-
-        size = tmp_i.size();
-
-        tmp_v.clear();
-        tmp_i.clear();
-
-        Polyline::modified = false;
+    // Only new & remeshed lines are uploaded
+    if (_batch_version != Polyline::batch_version) {
+        _syncBatch();
+        _batch_version = Polyline::batch_version;
     }
 
+    glm::mat4 const vp = camera ? camera->getVP() : glm::mat4(1);
+    // Only lines in view are drawn
+    _buildDrawList(vp);
+
     Material mat = swapMaterial("default"); 
-    mat.set("u_MVP", camera ? camera->getVP() : glm::mat4(1));
+    mat.set("u_MVP", vp);
+
+    // Line z attribute, only enabled for packed vertices
+    glVertexAttrib1f(2, 0.f);
+    if (_vertex_format == VertexFormat::Packed) {
+        if (!_commands.empty()) {
+            _lines_z_vbo.edit(_lines_z.size() * sizeof(float), _lines_z.data(), GL_STREAM_DRAW);
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _commands_buffer.id);
+            glBufferData(GL_DRAW_INDIRECT_BUFFER, _commands.size() * sizeof(_DrawCommand),
+                _commands.data(), GL_STREAM_DRAW);
+            glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr,
+                static_cast<GLsizei>(_commands.size()), 0);
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        }
+    }
+    else if (!_counts.empty()) {
+        glMultiDrawElementsBaseVertex(GL_TRIANGLES, _counts.data(), GL_UNSIGNED_INT,
+            _offsets.data(), static_cast<GLsizei>(_counts.size()), _base_vertices.data());
+    }
 
-    glDrawElements(GL_TRIANGLES, 3 * static_cast<GLsizei>(size), GL_UNSIGNED_INT, (void*)0);
+    // Transient lines are reallocated every frame, orphaning the storage
+    // used by the previous frame instead of waiting for its draw calls
+    if (!_transient_indices.empty()) {
+        _transient_vao.bind();
+        _transient_vbo.edit(_transient_vertices.size() * sizeof(Polyline::Vertex),
+            _transient_vertices.data(), GL_STREAM_DRAW);
+        _transient_ibo.edit(_transient_indices.size() * sizeof(Polyline::Indices),
+            _transient_indices.data(), GL_STREAM_DRAW);
+        glDrawElements(GL_TRIANGLES, 3 * static_cast<GLsizei>(_transient_indices.size()),
+            GL_UNSIGNED_INT, nullptr);
+    }
+    _transient_vertices.clear();
+    _transient_indices.clear();
 
     _vao.unbind();
 }
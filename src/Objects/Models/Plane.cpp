@@ -1,11 +1,14 @@
 #include "GL/Objects/Models/Plane.hpp"
 
+#include <execution>
+
 SSS_GL_BEGIN;
 
 void PlaneBase::_register()
 {
     REGISTER_EVENT("SSS_PLANE_ALPHA");
     REGISTER_EVENT("SSS_PLANE_TEXTURE_OFFSET");
+    REGISTER_EVENT("SSS_PLANE_ANIMATION");
 }
 
 std::strong_ordering operator<=>(std::reference_wrapper<PlaneBase> const& a, std::reference_wrapper<PlaneBase> const& b)
@@ -14,6 +17,7 @@ std::strong_ordering operator<=>(std::reference_wrapper<PlaneBase> const& a, std
 }
 
 std::set<std::reference_wrapper<PlaneBase>> PlaneBase::_instances{};
+std::vector<PlaneBase*> PlaneBase::_playing{};
 
 PlaneBase::PlaneBase() try
 {
@@ -24,6 +28,9 @@ CATCH_AND_RETHROW_METHOD_EXC;
 PlaneBase::~PlaneBase()
 {
     _instances.erase(*this);
+    // Removed on the next tick, which may be iterating right now
+    if (_playing_index != SIZE_MAX)
+        _playing[_playing_index] = nullptr;
 }
 
 glm::mat4 PlaneBase::_getScalingMat4() const
@@ -43,6 +50,92 @@ void PlaneBase::setTexture(Texture::Shared texture)
     _updateTexScaling();
     if (texture)
         _observe(*texture);
+    if (_animation_mode == AnimationMode::GPU)
+        EMIT_EVENT("SSS_PLANE_ANIMATION");
+}
+
+void PlaneBase::play()
+{
+    bool const was_playing = _is_playing;
+    _is_playing = true;
+    if (_animation_mode == AnimationMode::GPU) {
+        if (!was_playing) {
+            _gpu_start = _gpuClock();
+            EMIT_EVENT("SSS_PLANE_ANIMATION");
+        }
+        return;
+    }
+    if (_playing_index == SIZE_MAX) {
+        _playing_index = _playing.size();
+        _playing.push_back(this);
+    }
+}
+
+void PlaneBase::pause()
+{
+    if (_is_playing && _animation_mode == AnimationMode::GPU) {
+        _syncGPUAnimation();
+        _is_playing = false;
+        EMIT_EVENT("SSS_PLANE_ANIMATION");
+        return;
+    }
+    _is_playing = false;
+}
+
+void PlaneBase::stop()
+{
+    pause();
+    _animation_duration = std::chrono::nanoseconds(0);
+}
+
+void PlaneBase::setLooping(bool enable)
+{
+    if (_looping == enable) {
+        return;
+    }
+    if (_is_playing && _animation_mode == AnimationMode::GPU)
+        _syncGPUAnimation();
+    _looping = enable;
+    if (_animation_mode == AnimationMode::GPU)
+        EMIT_EVENT("SSS_PLANE_ANIMATION");
+}
+
+void PlaneBase::setAnimationMode(AnimationMode mode)
+{
+    if (_animation_mode == mode) {
+        return;
+    }
+    if (_is_playing && _animation_mode == AnimationMode::GPU)
+        _syncGPUAnimation();
+    _animation_mode = mode;
+    // Resume in the new mode, from the current position
+    if (_is_playing) {
+        _is_playing = false;
+        play();
+    }
+    EMIT_EVENT("SSS_PLANE_ANIMATION");
+}
+
+void PlaneBase::setAnimationSpeed(float speed)
+{
+    float const new_speed = std::max(speed, 0.f);
+    if (_animation_speed == new_speed) {
+        return;
+    }
+    // GPU animations are rebased, so that the current frame doesn't jump
+    if (_is_playing && _animation_mode == AnimationMode::GPU)
+        _syncGPUAnimation();
+    _animation_speed = new_speed;
+    if (_animation_mode == AnimationMode::GPU)
+        EMIT_EVENT("SSS_PLANE_ANIMATION");
+}
+
+void PlaneBase::_relinkPlaying()
+{
+    _playing_index = SIZE_MAX;
+    _advanced = false;
+    if (_is_playing)
+        play();
 }
 
 void PlaneBase::setAlpha(float alpha) noexcept
@@ -57,40 +150,127 @@ void PlaneBase::setAlpha(float alpha) noexcept
 void PlaneBase::_setTextureOffset(uint32_t offset)
 {
     if (_texture_offset != offset) {
+        uint32_t const old_layer = getTexOffset();
         _texture_offset = offset;
-        EMIT_EVENT("SSS_PLANE_TEXTURE_OFFSET");
+        if (_texture)
+            _texture->_frameRequested(_texture_offset);
+        // Identical frames share a layer, no need to update renderers
+        if (getTexOffset() != old_layer)
+            EMIT_EVENT("SSS_PLANE_TEXTURE_OFFSET");
     }
 }
 
-void PlaneBase::_updateTextureOffset()
+void PlaneBase::_advanceAnimation(std::chrono::nanoseconds elapsed) noexcept
 {
+    _advanced = true;
+    if (_animation_speed == 1.f)
+        _animation_duration += elapsed;
+    else {
+        _animation_duration += std::chrono::nanoseconds(static_cast<int64_t>(
+            static_cast<double>(elapsed.count()) * _animation_speed));
+    }
     if (!_texture || _texture->getFrames().total_time == std::chrono::nanoseconds(0)) {
-        _setTextureOffset(0);
+        _next_offset = 0;
         return;
     }
     auto const& frames = _texture->getFrames();
 
     // If loop disabled & animation completed, stop playing
-    if (!_looping && _animation_duration >= _texture->getFrames().total_time) {
+    if (!_looping && _animation_duration >= frames.total_time) {
         _is_playing = false;
         _animation_duration = std::chrono::nanoseconds(0);
-        _setTextureOffset(static_cast<uint32_t>(frames.size()) - 1);
     }
 
-    // Remove excess time
-    while (_animation_duration >= _texture->getFrames().total_time) {
-        _animation_duration -= _texture->getFrames().total_time;
-    }
+    // Remove excess time, then find current texture offset
+    _animation_duration %= frames.total_time;
+    _next_offset = frames.frameAt(_animation_duration);
+}
 
-    // Find current texture offset
-    auto duration = _animation_duration;
-    for (uint32_t i = 0; i < frames.size(); ++i) {
-        duration -= frames[i].delay;
-        if (duration < std::chrono::nanoseconds(0)) {
-            _setTextureOffset(i);
-            break;
+void PlaneBase::_tickAnimations(std::chrono::nanoseconds elapsed)
+{
+    // Drop destroyed & paused planes, filling holes with the last ones
+    for (size_t i = 0; i < _playing.size();) {
+        PlaneBase* plane = _playing[i];
+        if (plane != nullptr && plane->_is_playing && plane->_animation_mode == AnimationMode::CPU) {
+            ++i;
+            continue;
         }
+        if (plane != nullptr)
+            plane->_playing_index = SIZE_MAX;
+        _playing[i] = _playing.back();
+        _playing.pop_back();
+        if (i < _playing.size() && _playing[i] != nullptr)
+            _playing[i]->_playing_index = i;
+    }
+
+    // Planes only touch their own state (and read their texture's frames),
+    // which makes this phase safe to run in parallel for large counts.
+    static constexpr size_t parallel_threshold = 4096;
+    auto const advance = [elapsed](PlaneBase* plane) { plane->_advanceAnimation(elapsed); };
+    if (_playing.size() >= parallel_threshold)
+        std::for_each(std::execution::par, _playing.begin(), _playing.end(), advance);
+    else
+        std::for_each(_playing.begin(), _playing.end(), advance);
+
+    // Events are emitted on this thread. Callbacks may play, pause or
+    // delete planes: nothing is moved until the next tick, and planes
+    // appended meanwhile weren't advanced.
+    for (size_t i = 0; i < _playing.size(); ++i) {
+        PlaneBase* plane = _playing[i];
+        if (plane == nullptr || !plane->_advanced)
+            continue;
+        plane->_advanced = false;
+        plane->_setTextureOffset(plane->_next_offset);
+    }
+}
+
+uint32_t PlaneBase::_gpuClock() noexcept
+{
+    using namespace std::chrono;
+    static steady_clock::time_point const epoch = steady_clock::now();
+    // Wraps after ~49 days, which unsigned differences in the shader handle
+    return static_cast<uint32_t>(duration_cast<milliseconds>(steady_clock::now() - epoch).count());
+}
+
+void PlaneBase::_syncGPUAnimation()
+{
+    uint32_t const now = _gpuClock();
+    _advanceAnimation(std::chrono::milliseconds(now - _gpu_start));
+    _advanced = false;
+    _gpu_start = now;
+    _setTextureOffset(_next_offset);
+}
+
+glm::uvec4 PlaneBase::_getGPUAnimation(uint32_t table_offset) const noexcept
+{
+    // A null flag makes the shader use the CPU texture offset
+    if (!_is_playing || _animation_mode != AnimationMode::GPU) {
+        return glm::uvec4(0);
     }
+    float const base = std::chrono::duration<float, std::milli>(_animation_duration).count();
+    uint32_t const flags = 0x80000000u | (_looping ? 0x40000000u : 0u);
+    return glm::uvec4(_gpu_start, glm::floatBitsToUint(base),
+        glm::floatBitsToUint(_animation_speed), flags | table_offset);
+}
+
+uint32_t PlaneBase::_displayedFrame() const noexcept
+{
+    // _texture_offset only changes on pause, speed or loop changes in GPU mode
+    if (!_is_playing || _animation_mode != AnimationMode::GPU || !_texture) {
+        return _texture_offset;
+    }
+    auto const& frames = _texture->getFrames();
+    if (frames.total_time == std::chrono::nanoseconds(0)) {
+        return _texture_offset;
+    }
+    std::chrono::nanoseconds const elapsed = std::chrono::milliseconds(_gpuClock() - _gpu_start);
+    std::chrono::nanoseconds time = _animation_duration + std::chrono::nanoseconds(
+        static_cast<int64_t>(static_cast<double>(elapsed.count()) * _animation_speed));
+    if (_looping)
+        time %= frames.total_time;
+    else if (time >= frames.total_time)
+        time = std::chrono::nanoseconds(0);
+    return frames.frameAt(time);
 }
 
 void PlaneBase::_updateTexScaling()
@@ -136,11 +316,17 @@ void PlaneBase::_subjectUpdate(Subject const& subject, Event const& event)
     if (event_id == EVENT_ID("SSS_TEXTURE_RESIZE")) {
         _updateTexScaling();
         _animation_duration = std::chrono::nanoseconds(0);
+        _gpu_start = _gpuClock();
         _setTextureOffset(0);
         return;
     }
 
     if (event_id == EVENT_ID("SSS_TEXTURE_CONTENT")) {
+        // Frames may have been remapped to other layers
+        EMIT_EVENT("SSS_PLANE_TEXTURE_OFFSET");
+        // Frame delays may have changed as well
+        if (_animation_mode == AnimationMode::GPU)
+            EMIT_EVENT("SSS_PLANE_ANIMATION");
         if (_texture_callback)
             _texture_callback(*this);
         return;
@@ -206,30 +392,7 @@ bool PlaneBase::_hoverTriangle(glm::mat4 const& mvp, glm::vec3 const& A,
     }
 
     // Update status if the position is on an opaque pixel
-    size_t const pixel = static_cast<size_t>(_relative_y * _tex_w + _relative_x);
-    switch (_texture->getType()) {
-    case Texture::Type::Raw: {
-        if (pixel < _texture->getRawPixels(_texture_offset).size()) {
-            is_hovered = _texture->getRawPixels().at(pixel).a != 0;
-        }
-        break;
-    }
-    case Texture::Type::Text: {
-        TR::Area::Shared text_area = _texture->getTextArea();
-        if (text_area) {
-            int w, h;
-            text_area->pixelsGetDimensions(w, h);
-            size_t const size = static_cast<size_t>(w) * static_cast<size_t>(h);
-            if (pixel < size) {
-                void const* pixels = text_area->pixelsGet();
-                is_hovered = static_cast<RGBA32 const*>(pixels)[pixel].a != 0;
-            }
-        }
-        break;
-    }
-    default:
-        break;
-    }
+    is_hovered = _texture->isOpaque(_displayedFrame(), _relative_x, _relative_y);
 
     return true;
 }
@@ -1,6 +1,7 @@
 #include "GL/Objects/Models/PlaneRenderer.hpp"
 #include "GL/Window.hpp"
 #include <ranges>
+#include <unordered_map>
 
 SSS_GL_BEGIN;
 
@@ -40,6 +41,7 @@ PlaneRenderer::PlaneRenderer() try
 
             PLANE_ALPHA,
             PLANE_TEX_OFFSET,
+            PLANE_ANIMATION,
         };
 
         _static_vbo.bind();
@@ -72,6 +74,11 @@ PlaneRenderer::PlaneRenderer() try
         glEnableVertexAttribArray(PLANE_TEX_OFFSET);
         glVertexAttribIPointer(PLANE_TEX_OFFSET, 1, GL_UNSIGNED_INT, sizeof(uint32_t), (void*)0);
         glVertexAttribDivisor(PLANE_TEX_OFFSET, 1);
+
+        _animation_vbo.bind();
+        glEnableVertexAttribArray(PLANE_ANIMATION);
+        glVertexAttribIPointer(PLANE_ANIMATION, 4, GL_UNSIGNED_INT, sizeof(glm::uvec4), (void*)0);
+        glVertexAttribDivisor(PLANE_ANIMATION, 1);
         });
     _vao.unbind();
 
@@ -131,6 +138,7 @@ void PlaneRenderer::_subjectUpdate(Subject const& subject, Event const& event)
     int const event_id = event.id;
     if (event_id == EVENT_ID("SSS_MODEL_UPDATE")) {
         _model_vbo.needs_edit = true;
+        _grid_moved.insert(&subject);
         return;
     }
 
@@ -143,6 +151,11 @@ void PlaneRenderer::_subjectUpdate(Subject const& subject, Event const& event)
         _tex_offset_vbo.needs_edit = true;
         return;
     }
+
+    if (event_id == EVENT_ID("SSS_PLANE_ANIMATION")) {
+        _animation_vbo.needs_edit = true;
+        return;
+    }
 }
 
 template <typename C, typename T>
@@ -158,30 +171,49 @@ void PlaneRenderer::_updateVBO(T(C::* getMember)() const, Basic::VBO& vbo) {
     vbo.needs_edit = false;
 };
 
-void PlaneRenderer::render() try
+void PlaneRenderer::_updateAnimationVBO()
 {
-    if (!isActive()) {
-        return;
-    }
-
-	Material mat = _materials.at("default");
-    mat.bind();
-    auto shader = mat.getShader();
-    if (!shader) {
-        return;
-    }
-
-    mat.set("u_VP", (camera ? camera->getVP() : glm::mat4(1)));
-
-    _vao.bind();
+    // Per animated texture: frame count, total time, then an
+    // (end time, layer) pair per frame. Times are in milliseconds.
+    std::vector<float> table;
+    std::unordered_map<Texture const*, uint32_t> offsets;
+    auto const ms = [](std::chrono::nanoseconds time) {
+        return std::chrono::duration<float, std::milli>(time).count();
+    };
 
-    // Check if we need to reset the depth buffer before rendering
-    if (clear_depth_buffer) {
-        glClear(GL_DEPTH_BUFFER_BIT);
+    std::vector<glm::uvec4> vec;
+    vec.reserve(_planes.size());
+    for (std::shared_ptr<PlaneBase> const& plane : _planes) {
+        if (plane->isHidden() || plane->sdf_mode != PlaneBase::SDFMode::None)
+            continue;
+        uint32_t offset = 0;
+        if (plane->_texture && plane->_animation_mode == PlaneBase::AnimationMode::GPU) {
+            auto const [it, inserted] = offsets.try_emplace(plane->_texture.get(),
+                static_cast<uint32_t>(table.size()));
+            if (inserted) {
+                Texture::Frame::Vector const& frames = plane->_texture->getFrames();
+                size_t const count = std::min(frames.size(), frames.end_times.size());
+                table.push_back(static_cast<float>(count));
+                table.push_back(ms(frames.total_time));
+                for (size_t i = 0; i < count; ++i) {
+                    table.push_back(ms(frames.end_times[i]));
+                    table.push_back(static_cast<float>(frames[i].layer));
+                }
+            }
+            offset = it->second;
+        }
+        vec.push_back(plane->_getGPUAnimation(offset));
     }
+    // Empty buffers can't be bound
+    if (table.empty())
+        table.push_back(0.f);
+    _animation_vbo.edit(vec, GL_DYNAMIC_DRAW);
+    _animation_table.edit(table, GL_DYNAMIC_DRAW);
+    _animation_vbo.needs_edit = false;
+}
 
-
-    // Edit VBOs if needed
+void PlaneRenderer::_updateVBOs()
+{
     if (_update_vbos || _model_vbo.needs_edit)
         _updateVBO(&PlaneBase::getModelMat4, _model_vbo);
 
@@ -191,8 +223,14 @@ void PlaneRenderer::render() try
     if (_update_vbos || _tex_offset_vbo.needs_edit)
         _updateVBO(&PlaneBase::getTexOffset, _tex_offset_vbo);
 
+    if (_update_vbos || _animation_vbo.needs_edit)
+        _updateAnimationVBO();
+
     _update_vbos = false;
+}
 
+void PlaneRenderer::_drawInstances(Shaders& shader) const
+{
     uint32_t count = 0, offset = 0;
     std::vector<GLint> uv_modes;
     std::vector<glm::vec2> uv_offsets;
@@ -205,7 +243,7 @@ void PlaneRenderer::render() try
             continue;
 
         if (count == Window::maxGLSLTextureUnits()) {
-            _renderPart(*shader, count, offset, uv_modes, uv_offsets);
+            _renderPart(shader, count, offset, uv_modes, uv_offsets);
             uv_modes.clear();
             uv_offsets.clear();
         }
@@ -220,7 +258,40 @@ void PlaneRenderer::render() try
 
         ++count;
     }
-    _renderPart(*shader, count, offset, uv_modes, uv_offsets);
+    _renderPart(shader, count, offset, uv_modes, uv_offsets);
+}
+
+void PlaneRenderer::render() try
+{
+    if (!isActive()) {
+        return;
+    }
+
+	Material mat = _materials.at("default");
+    mat.bind();
+    auto shader = mat.getShader();
+    if (!shader) {
+        return;
+    }
+
+    mat.set("u_VP", (camera ? camera->getVP() : glm::mat4(1)));
+
+    _vao.bind();
+
+    // Check if we need to reset the depth buffer before rendering
+    if (clear_depth_buffer) {
+        glClear(GL_DEPTH_BUFFER_BIT);
+    }
+
+
+    // Edit VBOs if needed
+    _updateVBOs();
+
+    // GPU animations are computed from this clock
+    glUniform1ui(shader->getUniformLocation("u_Time"), PlaneBase::_gpuClock());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, _animation_table.id);
+
+    _drawInstances(*shader);
     _vao.unbind();
 
     // SDF planes: one non-instanced draw call per plane
@@ -270,6 +341,7 @@ void PlaneRenderer::addPlane(std::shared_ptr<PlaneBase> plane)
         _planes.push_back(plane);
         _observe(*plane);
         _update_vbos = true;
+        _grid_dirty = true;
     }
 }
 
@@ -285,6 +357,149 @@ void PlaneRenderer::removePlane(std::shared_ptr<PlaneBase> plane)
         ));
         _ignore(*plane);
         _update_vbos = true;
+        _grid_dirty = true;
+    }
+}
+
+// Planes covering more cells are tested on every picking
+static constexpr int max_plane_cells = 64;
+// Rays crossing more cells fall back to testing every plane
+static constexpr int max_ray_cells = 4096;
+// Range of cells covered by no plane
+static constexpr glm::ivec4 no_cells(1, 1, 0, 0);
+// Cell coordinates are clamped, so that cell counts fit in 64 bits
+static constexpr int max_cell = 1 << 30;
+// Range of cells of non-finite bounds (e.g. singular matrices)
+static constexpr glm::ivec4 all_cells(-max_cell, -max_cell, max_cell, max_cell);
+// Depth range covered by no plane
+static constexpr glm::vec2 no_depths(FLT_MAX, -FLT_MAX);
+
+static uint64_t cellKey(int x, int y) noexcept
+{
+    return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+}
+
+static int64_t cellCount(glm::ivec4 const& range) noexcept
+{
+    if (range.z < range.x || range.w < range.y)
+        return 0;
+    return (static_cast<int64_t>(range.z) - range.x + 1) * (static_cast<int64_t>(range.w) - range.y + 1);
+}
+
+static int cellCoord(float value, float cell_size) noexcept
+{
+    double const cell = std::floor(static_cast<double>(value) / cell_size);
+    return static_cast<int>(std::clamp(cell, static_cast<double>(-max_cell), static_cast<double>(max_cell)));
+}
+
+// Cells covered by the XY bounds of given points, all of them if they aren't finite
+static glm::ivec4 cellRange(glm::vec3 const& a, glm::vec3 const& b, float cell_size) noexcept
+{
+    if (!std::isfinite(a.x) || !std::isfinite(a.y) || !std::isfinite(b.x) || !std::isfinite(b.y))
+        return all_cells;
+    return glm::ivec4(
+        cellCoord(std::min(a.x, b.x), cell_size), cellCoord(std::min(a.y, b.y), cell_size),
+        cellCoord(std::max(a.x, b.x), cell_size), cellCoord(std::max(a.y, b.y), cell_size));
+}
+
+// World space bounds of the plane's quad
+static void planeBounds(PlaneBase& plane, glm::vec3& min, glm::vec3& max)
+{
+    glm::mat4 const model = plane.getModelMat4();
+    min = glm::vec3(FLT_MAX);
+    max = glm::vec3(-FLT_MAX);
+    for (glm::vec2 const corner : { glm::vec2(-0.5f, 0.5f), glm::vec2(-0.5f, -0.5f),
+        glm::vec2(0.5f, -0.5f), glm::vec2(0.5f, 0.5f) })
+    {
+        glm::vec3 const point(model * glm::vec4(corner, 0.f, 1.f));
+        min = glm::min(min, point);
+        max = glm::max(max, point);
+    }
+}
+
+void PlaneRenderer::_rebuildGrid()
+{
+    _grid.clear();
+    _grid_large.clear();
+    _grid_ids.clear();
+    _grid_moved.clear();
+    _grid_ranges.assign(_planes.size(), no_cells);
+    _grid_depths.assign(_planes.size(), no_depths);
+    _grid_z_min = FLT_MAX;
+    _grid_z_max = -FLT_MAX;
+    _grid_z_stale = false;
+
+    // Cells are sized after the average plane
+    float extent = 0.f;
+    uint32_t count = 0;
+    for (std::shared_ptr<PlaneBase> const& plane : _planes) {
+        if (!plane)
+            continue;
+        glm::vec3 min, max;
+        planeBounds(*plane, min, max);
+        float const plane_extent = std::max(max.x - min.x, max.y - min.y);
+        if (!std::isfinite(plane_extent))
+            continue;
+        extent += plane_extent;
+        ++count;
+    }
+    _grid_cell_size = count != 0 ? std::max(extent / static_cast<float>(count), 0.001f) : 1.f;
+
+    for (uint32_t id = 0; id < _planes.size(); ++id) {
+        if (!_planes[id])
+            continue;
+        _grid_ids[_planes[id].get()] = id;
+        _gridInsert(id);
+    }
+    _grid_dirty = false;
+}
+
+void PlaneRenderer::_gridInsert(uint32_t id)
+{
+    glm::vec3 min, max;
+    planeBounds(*_planes[id], min, max);
+    // Non-finite planes are always tested, and don't clip rays
+    if (std::isfinite(min.z) && std::isfinite(max.z)) {
+        _grid_depths[id] = glm::vec2(min.z, max.z);
+        _grid_z_min = std::min(_grid_z_min, min.z);
+        _grid_z_max = std::max(_grid_z_max, max.z);
+    }
+
+    glm::ivec4 const range = cellRange(min, max, _grid_cell_size);
+    _grid_ranges[id] = range;
+    if (cellCount(range) > max_plane_cells) {
+        _grid_large.push_back(id);
+        return;
+    }
+    for (int x = range.x; x <= range.z; ++x) {
+        for (int y = range.y; y <= range.w; ++y) {
+            _grid[cellKey(x, y)].push_back(id);
+        }
+    }
+}
+
+void PlaneRenderer::_gridRemove(uint32_t id)
+{
+    glm::ivec4 const range = _grid_ranges[id];
+    _grid_ranges[id] = no_cells;
+    // The z range shrinks if this plane was on its bounds
+    glm::vec2 const depths = _grid_depths[id];
+    _grid_depths[id] = no_depths;
+    if (depths.x <= _grid_z_min || depths.y >= _grid_z_max)
+        _grid_z_stale = true;
+    if (cellCount(range) > max_plane_cells) {
+        std::erase(_grid_large, id);
+        return;
+    }
+    for (int x = range.x; x <= range.z; ++x) {
+        for (int y = range.y; y <= range.w; ++y) {
+            auto const it = _grid.find(cellKey(x, y));
+            if (it == _grid.end())
+                continue;
+            std::erase(it->second, id);
+            if (it->second.empty())
+                _grid.erase(it);
+        }
     }
 }
 
@@ -302,10 +517,7 @@ bool PlaneRenderer::_findNearestModel(double x, double y)
     if (camera) {
         VP = camera->getVP();
     }
-    // Loop over each plane in chunk
-    for (std::shared_ptr<PlaneBase> const& plane : _planes | std::views::reverse) {
-        if (!plane)
-            continue;
+    auto const test = [&](std::shared_ptr<PlaneBase> const& plane) {
         // Check if plane is hovered and retrieve its relative depth
         double z = DBL_MAX;
         if (plane->_isHovered(VP, x, y, z)) {
@@ -318,8 +530,149 @@ bool PlaneRenderer::_findNearestModel(double x, double y)
                 _hovered = plane;
             }
         }
+    };
+
+    // Update the grid with planes moved since last picking
+    if (_grid_dirty) {
+        _rebuildGrid();
+    }
+    for (Subject const* moved : _grid_moved) {
+        auto const it = _grid_ids.find(moved);
+        if (it == _grid_ids.end())
+            continue;
+        _gridRemove(it->second);
+        _gridInsert(it->second);
+    }
+    _grid_moved.clear();
+    if (_grid_z_stale) {
+        _grid_z_min = FLT_MAX;
+        _grid_z_max = -FLT_MAX;
+        for (glm::vec2 const depths : _grid_depths) {
+            _grid_z_min = std::min(_grid_z_min, depths.x);
+            _grid_z_max = std::max(_grid_z_max, depths.y);
+        }
+        _grid_z_stale = false;
+    }
+
+    // Cursor ray in world space, clipped to the z range of the grid
+    glm::mat4 const inverse_vp = glm::inverse(VP);
+    glm::vec4 near = inverse_vp * glm::vec4(x, y, -1, 1);
+    glm::vec4 far = inverse_vp * glm::vec4(x, y, 1, 1);
+    glm::vec3 a = glm::vec3(near) / near.w;
+    glm::vec3 b = glm::vec3(far) / far.w;
+    glm::vec3 const direction = b - a;
+    if (std::abs(direction.z) > 1e-6f) {
+        float t0 = (_grid_z_min - a.z) / direction.z;
+        float t1 = (_grid_z_max - a.z) / direction.z;
+        if (t0 > t1)
+            std::swap(t0, t1);
+        t0 = std::clamp(t0, 0.f, 1.f);
+        t1 = std::clamp(t1, 0.f, 1.f);
+        b = a + direction * t1;
+        a = a + direction * t0;
+    }
+    // Non-finite ends (e.g. singular VP) span every cell
+    glm::ivec4 const ray_cells = cellRange(a, b, _grid_cell_size);
+
+    // Rays spanning too many cells (e.g. grazing perspective views)
+    if (cellCount(ray_cells) > max_ray_cells) {
+        for (std::shared_ptr<PlaneBase> const& plane : _planes | std::views::reverse) {
+            if (plane)
+                test(plane);
+        }
+        return result;
+    }
+
+    // Candidates are tested in the same reverse order as every plane would be
+    std::vector<uint32_t> candidates(_grid_large);
+    for (int cx = ray_cells.x; cx <= ray_cells.z; ++cx) {
+        for (int cy = ray_cells.y; cy <= ray_cells.w; ++cy) {
+            auto const it = _grid.find(cellKey(cx, cy));
+            if (it != _grid.end())
+                candidates.insert(candidates.end(), it->second.begin(), it->second.end());
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(), std::greater<uint32_t>());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    for (uint32_t const id : candidates) {
+        test(_planes[id]);
     }
     return result;
 }
 
+// Picking ID along with its hitbox (see preset picking shader)
+static uint32_t pickingValue(size_t id, PlaneBase::Hitbox hitbox) noexcept
+{
+    return static_cast<uint32_t>(id) | static_cast<uint32_t>(hitbox) << 30;
+}
+
+void PlaneRenderer::_renderPicking(std::vector<std::weak_ptr<PlaneBase>>& targets) try
+{
+    if (!isActive()) {
+        return;
+    }
+    auto shader = Window::getPresetShaders(static_cast<uint32_t>(Shaders::Preset::PlanePicking));
+    if (!shader) {
+        return;
+    }
+    shader->use();
+    shader->setUniform("u_VP", (camera ? camera->getVP() : glm::mat4(1)));
+
+    // Check if we need to reset the depth buffer before rendering
+    if (clear_depth_buffer) {
+        glClear(GL_DEPTH_BUFFER_BIT);
+    }
+
+    _vao.bind();
+    _updateVBOs();
+
+    // Picking values of instanced planes, filtered like other instance VBOs.
+    // Hitboxes aren't observed, so this VBO is edited on each pass.
+    std::vector<uint32_t> picks;
+    picks.reserve(_planes.size());
+    for (std::shared_ptr<PlaneBase> const& plane : _planes) {
+        if (plane->isHidden() || plane->sdf_mode != PlaneBase::SDFMode::None)
+            continue;
+        targets.push_back(plane);
+        picks.push_back(pickingValue(targets.size(), plane->getHitbox()));
+    }
+    if (!picks.empty()) {
+        _pick_vbo.edit(picks, GL_STREAM_DRAW);
+        glEnableVertexAttribArray(9);
+        glVertexAttribIPointer(9, 1, GL_UNSIGNED_INT, sizeof(uint32_t), (void*)0);
+        glVertexAttribDivisor(9, 1);
+
+        glUniform1ui(shader->getUniformLocation("u_Time"), PlaneBase::_gpuClock());
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, _animation_table.id);
+        _drawInstances(*shader);
+
+        // Regular renders use the (null) generic value instead
+        glDisableVertexAttribArray(9);
+    }
+    _vao.unbind();
+
+    // SDF planes have full quad hitboxes. Their VAO leaves instanced
+    // locations disabled, so generic attribute values are used instead.
+    _sdf_plane_vao.bind();
+    glVertexAttribI4ui(8, 0, 0, 0, 0);
+    glVertexAttribI1ui(7, 0);
+    for (std::shared_ptr<PlaneBase> const& plane : _planes) {
+        if (plane->isHidden() || plane->sdf_mode == PlaneBase::SDFMode::None)
+            continue;
+        if (plane->sdf_prims.empty() || plane->getHitbox() == PlaneBase::Hitbox::None)
+            continue;
+
+        glm::mat4 const model = plane->getModelMat4();
+        for (GLuint column = 0; column < 4; ++column) {
+            glVertexAttrib4fv(2 + column, &model[column].x);
+        }
+        targets.push_back(plane);
+        glVertexAttribI1ui(9, pickingValue(targets.size(), PlaneBase::Hitbox::Full));
+        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);
+    }
+    glVertexAttribI1ui(9, 0);
+    _sdf_plane_vao.unbind();
+}
+CATCH_AND_RETHROW_METHOD_EXC;
+
 SSS_GL_END;
\ No newline at end of file
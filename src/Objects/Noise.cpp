@@ -1,177 +1,698 @@
 #include "GL/Objects/Noise.hpp"
+#include "GL/Objects/Shaders.hpp"
+#include "GL/Window.hpp"
 
 #include <FastNoise/FastNoise.h>
 #include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <thread>
 
 SSS_GL_BEGIN;
 
+std::set<Noise*> Noise::_pending;
+std::unordered_map<std::string, Noise::_CacheEntry> Noise::_cache;
+size_t Noise::_cache_budget{ 64 << 20 };
+size_t Noise::_cache_bytes{ 0 };
+uint64_t Noise::_cache_clock{ 0 };
+std::string Noise::_cache_folder;
+
 Noise::Noise()
     : Texture()
 {
+    _observe(_generating_thread);
 }
 
-Noise::~Noise() = default;
+Noise::~Noise()
+{
+    _pending.erase(this);
+}
 
 Noise::Shared Noise::create(Type type, int width, int height, float frequency, int seed)
+{
+    Params params;
+    params.noise_type = type;
+    params.width      = width;
+    params.height     = height;
+    params.frequency  = frequency;
+    params.seed       = seed;
+    return create(params);
+}
+
+Noise::Shared Noise::create(Params const& params)
 {
     Shared ret(new Noise());
-    ret->_noise_type = type;
-    ret->_width      = width;
-    ret->_height     = height;
-    ret->_frequency  = frequency;
-    ret->_seed       = seed;
-    ret->_generate();
+    ret->_params = params;
+    ret->regenerate();
     return ret;
 }
 
+void Noise::setParams(Params const& params)
+{
+    if (_params != params) {
+        _params = params;
+        _invalidate();
+    }
+}
+
+void Noise::beginEdit() noexcept
+{
+    ++_edit_depth;
+}
+
+void Noise::endEdit()
+{
+    if (_edit_depth == 0) {
+        return;
+    }
+    if (--_edit_depth == 0 && _dirty) {
+        _dirty = false;
+        _pending.insert(this);
+    }
+}
+
+bool Noise::isGenerating() const noexcept
+{
+    return _pending.contains(const_cast<Noise*>(this)) || _generating_thread.isRunning();
+}
+
 void Noise::setNoiseType(Type type)
 {
-    if (_noise_type != type) {
-        _noise_type = type;
-        _generate();
+    if (_params.noise_type != type) {
+        _params.noise_type = type;
+        _invalidate();
     }
 }
 
 void Noise::setDimensions(int width, int height)
 {
-    if (_width != width || _height != height) {
-        _width  = width;
-        _height = height;
-        _generate();
+    if (_params.width != width || _params.height != height) {
+        _params.width  = width;
+        _params.height = height;
+        _invalidate();
     }
 }
 
 void Noise::setFrequency(float frequency)
 {
-    if (_frequency != frequency) {
-        _frequency = frequency;
-        _generate();
+    if (_params.frequency != frequency) {
+        _params.frequency = frequency;
+        _invalidate();
     }
 }
 
 void Noise::setSeed(int seed)
 {
-    if (_seed != seed) {
-        _seed = seed;
-        _generate();
+    if (_params.seed != seed) {
+        _params.seed = seed;
+        _invalidate();
     }
 }
 
 void Noise::setCellularDistanceFunc(CellularDistanceFunc func)
 {
-    if (_cell_dist_func != func) {
-        _cell_dist_func = func;
-        _generate();
+    if (_params.cell_dist_func != func) {
+        _params.cell_dist_func = func;
+        _invalidate();
     }
 }
 
 void Noise::setCellularReturnType(CellularReturnType type)
 {
-    if (_cell_return_type != type) {
-        _cell_return_type = type;
-        _generate();
+    if (_params.cell_return_type != type) {
+        _params.cell_return_type = type;
+        _invalidate();
     }
 }
 
 void Noise::setCellularGridJitter(float jitter)
 {
-    if (_cell_grid_jitter != jitter) {
-        _cell_grid_jitter = jitter;
-        _generate();
+    if (_params.cell_grid_jitter != jitter) {
+        _params.cell_grid_jitter = jitter;
+        _invalidate();
     }
 }
 
 void Noise::setCellularSizeJitter(float jitter)
 {
-    if (_cell_size_jitter != jitter) {
-        _cell_size_jitter = jitter;
-        _generate();
+    if (_params.cell_size_jitter != jitter) {
+        _params.cell_size_jitter = jitter;
+        _invalidate();
     }
 }
 
 void Noise::setCellularValueIndex(int index)
 {
-    if (_cell_value_index != index) {
-        _cell_value_index = index;
-        _generate();
+    if (_params.cell_value_index != index) {
+        _params.cell_value_index = index;
+        _invalidate();
     }
 }
 
 void Noise::setCellularDistanceIndex0(int index)
 {
-    if (_cell_dist_index0 != index) {
-        _cell_dist_index0 = index;
-        _generate();
+    if (_params.cell_dist_index0 != index) {
+        _params.cell_dist_index0 = index;
+        _invalidate();
     }
 }
 
 void Noise::setCellularDistanceIndex1(int index)
 {
-    if (_cell_dist_index1 != index) {
-        _cell_dist_index1 = index;
-        _generate();
+    if (_params.cell_dist_index1 != index) {
+        _params.cell_dist_index1 = index;
+        _invalidate();
     }
 }
 
 void Noise::setDomainWarpType(DomainWarpType type)
 {
-    if (_warp_type != type) {
-        _warp_type = type;
-        _generate();
+    if (_params.warp_type != type) {
+        _params.warp_type = type;
+        _invalidate();
     }
 }
 
 void Noise::setDomainWarpAmplitude(float amplitude)
 {
-    if (_warp_amplitude != amplitude) {
-        _warp_amplitude = amplitude;
-        _generate();
+    if (_params.warp_amplitude != amplitude) {
+        _params.warp_amplitude = amplitude;
+        _invalidate();
     }
 }
 
 void Noise::setDomainWarpFrequency(float frequency)
 {
-    if (_warp_frequency != frequency) {
-        _warp_frequency = frequency;
-        _generate();
+    if (_params.warp_frequency != frequency) {
+        _params.warp_frequency = frequency;
+        _invalidate();
     }
 }
 
 void Noise::setFractalType(FractalType type)
 {
-    if (_fractal_type != type) {
-        _fractal_type = type;
-        _generate();
+    if (_params.fractal_type != type) {
+        _params.fractal_type = type;
+        _invalidate();
     }
 }
 
 void Noise::setFractalOctaves(int octaves)
 {
-    if (_fractal_octaves != octaves) {
-        _fractal_octaves = octaves;
-        _generate();
+    if (_params.fractal_octaves != octaves) {
+        _params.fractal_octaves = octaves;
+        _invalidate();
     }
 }
 
 void Noise::setFractalLacunarity(float lacunarity)
 {
-    if (_fractal_lacunarity != lacunarity) {
-        _fractal_lacunarity = lacunarity;
-        _generate();
+    if (_params.fractal_lacunarity != lacunarity) {
+        _params.fractal_lacunarity = lacunarity;
+        _invalidate();
     }
 }
 
 void Noise::setFractalGain(float gain)
 {
-    if (_fractal_gain != gain) {
-        _fractal_gain = gain;
-        _generate();
+    if (_params.fractal_gain != gain) {
+        _params.fractal_gain = gain;
+        _invalidate();
+    }
+}
+
+void Noise::setDepth(int depth)
+{
+    if (_params.depth != depth) {
+        _params.depth = depth;
+        _invalidate();
+    }
+}
+
+void Noise::setSliceStep(float step)
+{
+    if (_params.slice_step != step) {
+        _params.slice_step = step;
+        _invalidate();
     }
 }
 
+void Noise::setSliceDelay(std::chrono::nanoseconds delay)
+{
+    if (_params.slice_delay != delay) {
+        _params.slice_delay = delay;
+        _invalidate();
+    }
+}
+
+void Noise::setFormat(GLenum format)
+{
+    if (_params.format != format) {
+        _params.format = format;
+        _invalidate();
+    }
+}
+
+void Noise::setColorRamp(std::vector<glm::vec4> const& colors)
+{
+    if (_params.color_ramp != colors) {
+        _params.color_ramp = colors;
+        _invalidate();
+    }
+}
+
+void Noise::setBackend(Backend backend)
+{
+    if (_params.backend != backend) {
+        _params.backend = backend;
+        _invalidate();
+    }
+}
+
+void Noise::setCacheBudget(size_t bytes)
+{
+    _cache_budget = bytes;
+    _cacheTrim(_cache_budget);
+}
+
+void Noise::clearCache() noexcept
+{
+    _cache.clear();
+    _cache_bytes = 0;
+}
+
+void Noise::setCacheFolder(std::string const& folder)
+{
+    _cache_folder = folder;
+}
+
 void Noise::regenerate()
 {
-    _generate();
+    _pending.erase(this);
+    _dirty = false;
+    if (_params.width <= 0 || _params.height <= 0)
+        return;
+    if (_params.backend == Backend::GPU) {
+        _generateGPU();
+        return;
+    }
+    if (_applyCached())
+        return;
+    Frame::Vector frames;
+    if (_cache_folder.empty() || !_loadFile(_cache_folder, _params, frames)) {
+        _generate(_params, frames);
+        if (!_cache_folder.empty())
+            _saveFile(_cache_folder, _params, frames);
+    }
+    if (_cache_budget != 0) {
+        _CacheEntry entry;
+        entry.frames = frames;
+        _cacheStore(_cacheKey(_params), std::move(entry));
+    }
+    _applyFrames(std::move(frames));
+}
+
+void Noise::_invalidate()
+{
+    if (_edit_depth != 0)
+        _dirty = true;
+    else
+        _pending.insert(this);
+}
+
+void Noise::_pollPending()
+{
+    for (auto it = _pending.begin(); it != _pending.end();) {
+        Noise* noise = *it;
+        // GPU generation is synchronous, and drops any CPU result
+        if (noise->_params.backend == Backend::GPU) {
+            it = _pending.erase(it);
+            if (noise->_params.width > 0 && noise->_params.height > 0)
+                noise->_generateGPU();
+            continue;
+        }
+        // Erased first, as callbacks may invalidate the noise again.
+        // Set iterators stay valid, and re-inserted noises sort
+        // before the next one, so they are polled next frame.
+        it = _pending.erase(it);
+        // Cached results are applied right away, the running
+        // generation (if any) is outdated and will be dropped
+        if (noise->_applyCached())
+            continue;
+        // Wait for the current generation, parameters may still change
+        if (noise->_generating_thread.isRunning()) {
+            _pending.insert(noise);
+            continue;
+        }
+        noise->_generating_thread.run(noise->_params, _cache_folder);
+    }
+}
+
+void Noise::_subjectUpdate(Subject const& subject, Event const& event)
+{
+    if (!subject.is<_AsyncGenerating>()) {
+        Texture::_subjectUpdate(subject, event);
+        return;
+    }
+    // Outdated results are dropped, a newer generation is pending
+    Frame::Vector& frames = _generating_thread._generated;
+    if (_generating_thread._params == _params && !frames.empty()) {
+        if (_cache_budget != 0) {
+            _CacheEntry entry;
+            entry.frames = frames;
+            _cacheStore(_cacheKey(_params), std::move(entry));
+        }
+        _applyFrames(std::move(frames));
+    }
+    frames = Frame::Vector();
+}
+
+void Noise::_applyFrames(Frame::Vector&& frames)
+{
+    // Slices are never identical, layers were mapped by _generate()
+    _frames = std::move(frames);
+    _internalEdit(Type::Raw);
+}
+
+void Noise::_AsyncGenerating::_asyncFunction(Params params, std::string folder)
+{
+    _params = params;
+    _generated = Frame::Vector();
+    if (params.width <= 0 || params.height <= 0)
+        return;
+    Frame::Vector frames;
+    if (folder.empty() || !_loadFile(folder, params, frames)) {
+        _generate(params, frames);
+        if (_beingCanceled()) return;
+        if (!folder.empty())
+            _saveFile(folder, params, frames);
+    }
+    if (_beingCanceled()) return;
+    _generated = std::move(frames);
+}
+
+void Noise::_generateGPU() try
+{
+    std::string const key = _cacheKey(_params);
+    _CacheEntry const* cached = _cacheFind(key);
+    if (cached != nullptr && !cached->texture) {
+        cached = nullptr;
+    }
+    Shaders::Shared shaders;
+    if (cached == nullptr) {
+        shaders = Window::getPresetShaders(static_cast<uint32_t>(Shaders::Preset::NoiseCompute));
+        if (!shaders) {
+            throw_exc("No noise compute shader, was a Window created?");
+        }
+    }
+
+    // Layers without pixels, written by the compute shader or copied below.
+    // The noise is fully opaque, which hit tests read from alpha masks.
+    int const depth = std::max(_params.depth, 1);
+    Frame::Vector frames;
+    _setupSlices(_params, frames);
+    size_t const pixel_count = static_cast<size_t>(_params.width) * static_cast<size_t>(_params.height);
+    for (Frame& frame : frames) {
+        frame.alpha_mask.assign((pixel_count + 63) / 64, ~uint64_t(0));
+    }
+    frames.format = GL_RGBA8;
+    // Only allocates storage, observers are notified once it's written
+    _frames = std::move(frames);
+    bool const resized = _internalEditQuiet(Type::Raw);
+
+    // Cached results are copied GPU-side, without any dispatch
+    if (cached != nullptr) {
+        glCopyImageSubData(cached->texture->id, GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0,
+            _raw_texture.id, GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0,
+            _params.width, _params.height, depth);
+        glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT);
+        _notifyEdit(resized);
+        return;
+    }
+
+    shaders->use();
+    glUniform2i(shaders->getUniformLocation("u_Size"), _params.width, _params.height);
+    shaders->setUniform("u_Layer", 0);
+    shaders->setUniform("u_Z", 0.f);
+    shaders->setUniform("u_ZStep", _params.slice_step * _params.frequency);
+    shaders->setUniform("u_Type", static_cast<int>(_params.noise_type));
+    shaders->setUniform("u_Frequency", _params.frequency);
+    shaders->setUniform("u_Seed", _params.seed);
+    shaders->setUniform("u_CellDistFunc", static_cast<int>(_params.cell_dist_func));
+    shaders->setUniform("u_CellReturnType", static_cast<int>(_params.cell_return_type));
+    shaders->setUniform("u_CellGridJitter", _params.cell_grid_jitter);
+    shaders->setUniform("u_CellValueIndex", _params.cell_value_index);
+    shaders->setUniform("u_CellDistIndex0", _params.cell_dist_index0);
+    shaders->setUniform("u_CellDistIndex1", _params.cell_dist_index1);
+    shaders->setUniform("u_WarpType", static_cast<int>(_params.warp_type));
+    shaders->setUniform("u_WarpAmplitude", _params.warp_amplitude);
+    shaders->setUniform("u_WarpFrequency", _params.warp_frequency);
+    shaders->setUniform("u_FractalType", static_cast<int>(_params.fractal_type));
+    shaders->setUniform("u_FractalOctaves", _params.fractal_octaves);
+    shaders->setUniform("u_FractalLacunarity", _params.fractal_lacunarity);
+    shaders->setUniform("u_FractalGain", _params.fractal_gain);
+
+    glBindImageTexture(0, _raw_texture.id, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA8);
+    shaders->dispatch((_params.width + 15) / 16, (_params.height + 15) / 16, depth);
+    // Make the result visible to subsequent texture fetches & copies
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT
+        | GL_TEXTURE_UPDATE_BARRIER_BIT);
+    _notifyEdit(resized);
+
+    // Keep a copy of the result, unless it couldn't fit the cache
+    _CacheEntry entry;
+    entry.bytes = static_cast<size_t>(_params.width) * static_cast<size_t>(_params.height)
+        * static_cast<size_t>(depth) * sizeof(RGBA32);
+    if (entry.bytes > _cache_budget) {
+        return;
+    }
+    entry.texture = std::make_unique<Basic::Texture>(GL_TEXTURE_2D_ARRAY);
+    entry.texture->editSettings(_params.width, _params.height, depth, GL_RGBA8);
+    glCopyImageSubData(_raw_texture.id, GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0,
+        entry.texture->id, GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0,
+        _params.width, _params.height, depth);
+    _cacheStore(key, std::move(entry));
+}
+CATCH_AND_RETHROW_METHOD_EXC;
+
+namespace {
+
+template <typename T>
+void append(std::string& out, T const& value)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    out.append(reinterpret_cast<char const*>(&value), sizeof(T));
+}
+
+// FNV-1a, stable across runs unlike std::hash
+uint64_t fnv1a(std::string const& data) noexcept
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (char const c : data) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+// Magic bytes of cache files, to be bumped if their layout
+// or the generation output ever changes
+constexpr char cache_magic[8] = { 'S', 'S', 'S', 'N', 'O', 'I', 'S', '1' };
+
+std::string cache_path(std::string const& folder, std::string const& key)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.noise",
+        static_cast<unsigned long long>(fnv1a(key)));
+    return folder + name;
+}
+
+// Byte size of a generated frame's pixels or texels
+size_t frame_bytes(Texture::Frame const& frame) noexcept
+{
+    return frame.pixels.size() * sizeof(RGBA32) + frame.blocks.size();
+}
+
+} // namespace
+
+std::string Noise::_cacheKey(Params const& params)
+{
+    std::string key;
+    key.reserve(128);
+    append(key, params.noise_type);
+    append(key, params.width);
+    append(key, params.height);
+    append(key, params.frequency);
+    append(key, params.seed);
+    append(key, params.depth);
+    append(key, params.slice_step);
+    append(key, params.slice_delay.count());
+    append(key, params.cell_dist_func);
+    append(key, params.cell_return_type);
+    append(key, params.cell_grid_jitter);
+    append(key, params.cell_size_jitter);
+    append(key, params.cell_value_index);
+    append(key, params.cell_dist_index0);
+    append(key, params.cell_dist_index1);
+    append(key, params.warp_type);
+    append(key, params.warp_amplitude);
+    append(key, params.warp_frequency);
+    append(key, params.fractal_type);
+    append(key, params.fractal_octaves);
+    append(key, params.fractal_lacunarity);
+    append(key, params.fractal_gain);
+    append(key, _format(params));
+    append(key, params.backend);
+    append(key, params.color_ramp.size());
+    for (glm::vec4 const& color : params.color_ramp) {
+        append(key, color);
+    }
+    return key;
+}
+
+Noise::_CacheEntry* Noise::_cacheFind(std::string const& key)
+{
+    auto const it = _cache.find(key);
+    if (it == _cache.end()) {
+        return nullptr;
+    }
+    it->second.last_used = ++_cache_clock;
+    return &it->second;
+}
+
+void Noise::_cacheStore(std::string const& key, _CacheEntry&& entry)
+{
+    if (entry.bytes == 0) {
+        for (Frame const& frame : entry.frames)
+            entry.bytes += frame_bytes(frame);
+    }
+    if (entry.bytes > _cache_budget) {
+        return;
+    }
+    if (auto const it = _cache.find(key); it != _cache.end()) {
+        _cache_bytes -= it->second.bytes;
+        _cache.erase(it);
+    }
+    // Make room first, so that the new entry isn't evicted
+    _cacheTrim(_cache_budget - entry.bytes);
+    entry.last_used = ++_cache_clock;
+    _cache_bytes += entry.bytes;
+    _cache.emplace(key, std::move(entry));
+}
+
+void Noise::_cacheTrim(size_t budget) noexcept
+{
+    while (_cache_bytes > budget && !_cache.empty()) {
+        auto oldest = _cache.begin();
+        for (auto it = _cache.begin(); it != _cache.end(); ++it) {
+            if (it->second.last_used < oldest->second.last_used)
+                oldest = it;
+        }
+        _cache_bytes -= oldest->second.bytes;
+        _cache.erase(oldest);
+    }
+}
+
+bool Noise::_applyCached()
+{
+    _CacheEntry const* entry = _cacheFind(_cacheKey(_params));
+    if (entry == nullptr || entry->frames.empty()) {
+        return false;
+    }
+    Frame::Vector frames = entry->frames;
+    _applyFrames(std::move(frames));
+    return true;
+}
+
+bool Noise::_loadFile(std::string const& folder, Params const& params, Frame::Vector& frames)
+{
+    std::string const key = _cacheKey(params);
+    FILE* f;
+    if (fopen_s(&f, cache_path(folder, key).c_str(), "rb") != 0) {
+        return false;
+    }
+    // Header: magic, then the full key, as names may collide
+    char magic[sizeof(cache_magic)];
+    uint64_t key_size = 0;
+    std::string file_key;
+    bool ok = fread(magic, 1, sizeof(magic), f) == sizeof(magic)
+        && std::memcmp(magic, cache_magic, sizeof(magic)) == 0
+        && fread(&key_size, sizeof(key_size), 1, f) == 1
+        && key_size == key.size();
+    if (ok) {
+        file_key.resize(key.size());
+        ok = fread(file_key.data(), 1, file_key.size(), f) == file_key.size()
+            && file_key == key;
+    }
+    // Slices are laid out as _generate() outputs them
+    if (ok) {
+        _setupSlices(params, frames);
+        size_t const count = static_cast<size_t>(params.width) * static_cast<size_t>(params.height);
+        GLenum format, type;
+        size_t const bytes = count * Basic::Texture::texelFormat(frames.format, format, type);
+        for (Frame& frame : frames) {
+            void* data;
+            if (frames.format == GL_RGBA8) {
+                frame.pixels.resize(count);
+                data = frame.pixels.data();
+            }
+            else {
+                frame.blocks.resize(bytes);
+                data = frame.blocks.data();
+            }
+            if (fread(data, 1, bytes, f) != bytes) {
+                ok = false;
+                break;
+            }
+        }
+    }
+    fclose(f);
+    if (!ok) {
+        frames = Frame::Vector();
+    }
+    return ok;
+}
+
+void Noise::_saveFile(std::string const& folder, Params const& params, Frame::Vector const& frames)
+{
+    std::string const key = _cacheKey(params);
+    std::string const path = cache_path(folder, key);
+    // Written under a unique name then renamed, so that concurrent writers
+    // and crashes never leave a truncated file under the final name
+    static std::atomic<uint64_t> tmp_count{ 0 };
+    char suffix[64];
+    snprintf(suffix, sizeof(suffix), ".%zx.%llx.tmp",
+        std::hash<std::thread::id>{}(std::this_thread::get_id()),
+        static_cast<unsigned long long>(tmp_count++));
+    std::string const tmp_path = path + suffix;
+
+    FILE* f;
+    if (fopen_s(&f, tmp_path.c_str(), "wb") != 0) {
+        return;
+    }
+    uint64_t const key_size = key.size();
+    bool ok = fwrite(cache_magic, 1, sizeof(cache_magic), f) == sizeof(cache_magic)
+        && fwrite(&key_size, sizeof(key_size), 1, f) == 1
+        && fwrite(key.data(), 1, key.size(), f) == key.size();
+    for (Frame const& frame : frames) {
+        if (!ok)
+            break;
+        if (frames.format == GL_RGBA8)
+            ok = fwrite(frame.pixels.data(), sizeof(RGBA32), frame.pixels.size(), f) == frame.pixels.size();
+        else
+            ok = fwrite(frame.blocks.data(), 1, frame.blocks.size(), f) == frame.blocks.size();
+    }
+    ok = fclose(f) == 0 && ok;
+
+    std::error_code error;
+    if (ok) {
+        std::filesystem::rename(tmp_path, path, error);
+    }
+    if (!ok || error) {
+        std::filesystem::remove(tmp_path, error);
+    }
 }
 
 namespace {
@@ -200,17 +721,39 @@ FastNoise::CellularDistance::ReturnType toFNReturnType(Noise::CellularReturnType
 
 } // namespace
 
-void Noise::_generate()
+GLenum Noise::_format(Params const& params) noexcept
+{
+    if (params.format == GL_R8 || params.format == GL_R32F)
+        return params.format;
+    return GL_RGBA8;
+}
+
+void Noise::_setupSlices(Params const& params, Frame::Vector& frames)
+{
+    int const depth = std::max(params.depth, 1);
+    frames = Frame::Vector(static_cast<size_t>(depth));
+    frames.w = params.width;
+    frames.h = params.height;
+    frames.format = _format(params);
+    frames.layers.resize(depth);
+    std::chrono::nanoseconds const delay = depth > 1 ? params.slice_delay : std::chrono::nanoseconds(0);
+    for (int i = 0; i < depth; ++i) {
+        frames[i].delay = delay;
+        frames[i].layer = static_cast<uint32_t>(i);
+        frames.layers[i] = static_cast<uint32_t>(i);
+    }
+    frames.total_time = delay * depth;
+}
+
+void Noise::_generate(Params const& params, Frame::Vector& frames, int x_offset, int y_offset)
 {
-    if (_width <= 0 || _height <= 0)
-        return;
 
     // Build the base generator node.
     // SetScale(1.0f) is called on each concrete type to neutralize the default
-    // Scale=100 so that _frequency (via GenUniformGrid2D step sizes) is the
+    // Scale=100 so that frequency (via GenUniformGrid2D step sizes) is the
     // sole frequency control.
     FastNoise::SmartNode<FastNoise::Generator> base;
-    switch (_noise_type) {
+    switch (params.noise_type) {
     case Type::OpenSimplex2: {
         auto n = FastNoise::New<FastNoise::Simplex>();
         n->SetScale(1.0f);
@@ -243,22 +786,22 @@ void Noise::_generate()
     case Type::CellularValue: {
         auto n = FastNoise::New<FastNoise::CellularValue>();
         n->SetScale(1.0f);
-        n->SetDistanceFunction(toFNDistFunc(_cell_dist_func));
-        n->SetGridJitter(_cell_grid_jitter);
-        n->SetSizeJitter(_cell_size_jitter);
-        n->SetValueIndex(_cell_value_index);
+        n->SetDistanceFunction(toFNDistFunc(params.cell_dist_func));
+        n->SetGridJitter(params.cell_grid_jitter);
+        n->SetSizeJitter(params.cell_size_jitter);
+        n->SetValueIndex(params.cell_value_index);
         base = n;
         break;
     }
     case Type::CellularDistance: {
         auto n = FastNoise::New<FastNoise::CellularDistance>();
         n->SetScale(1.0f);
-        n->SetDistanceFunction(toFNDistFunc(_cell_dist_func));
-        n->SetReturnType(toFNReturnType(_cell_return_type));
-        n->SetGridJitter(_cell_grid_jitter);
-        n->SetSizeJitter(_cell_size_jitter);
-        n->SetDistanceIndex0(_cell_dist_index0);
-        n->SetDistanceIndex1(_cell_dist_index1);
+        n->SetDistanceFunction(toFNDistFunc(params.cell_dist_func));
+        n->SetReturnType(toFNReturnType(params.cell_return_type));
+        n->SetGridJitter(params.cell_grid_jitter);
+        n->SetSizeJitter(params.cell_size_jitter);
+        n->SetDistanceIndex0(params.cell_dist_index0);
+        n->SetDistanceIndex1(params.cell_dist_index1);
         base = n;
         break;
     }
@@ -266,22 +809,22 @@ void Noise::_generate()
 
     // Optionally wrap in a fractal node
     FastNoise::SmartNode<FastNoise::Generator> root = base;
-    switch (_fractal_type) {
+    switch (params.fractal_type) {
     case FractalType::FBm: {
         auto frac = FastNoise::New<FastNoise::FractalFBm>();
         frac->SetSource(base);
-        frac->SetOctaveCount(_fractal_octaves);
-        frac->SetLacunarity(_fractal_lacunarity);
-        frac->SetGain(_fractal_gain);
+        frac->SetOctaveCount(params.fractal_octaves);
+        frac->SetLacunarity(params.fractal_lacunarity);
+        frac->SetGain(params.fractal_gain);
         root = frac;
         break;
     }
     case FractalType::Ridged: {
         auto frac = FastNoise::New<FastNoise::FractalRidged>();
         frac->SetSource(base);
-        frac->SetOctaveCount(_fractal_octaves);
-        frac->SetLacunarity(_fractal_lacunarity);
-        frac->SetGain(_fractal_gain);
+        frac->SetOctaveCount(params.fractal_octaves);
+        frac->SetLacunarity(params.fractal_lacunarity);
+        frac->SetGain(params.fractal_gain);
         root = frac;
         break;
     }
@@ -291,24 +834,67 @@ void Noise::_generate()
 
     // Optionally apply domain warp: warps input coordinates before the cellular lookup,
     // giving cells organic fluid shapes while preserving crisp Voronoi edges.
-    if (_warp_type != DomainWarpType::None) {
+    if (params.warp_type != DomainWarpType::None) {
         auto warpNode = FastNoise::New<FastNoise::DomainWarpGradient>();
         warpNode->SetSource(root);
-        warpNode->SetWarpAmplitude(_warp_amplitude);
-        warpNode->SetScale(_warp_frequency);
+        warpNode->SetWarpAmplitude(params.warp_amplitude);
+        warpNode->SetScale(params.warp_frequency);
         root = warpNode;
     }
 
-    std::vector<float> noise(static_cast<size_t>(_width) * static_cast<size_t>(_height));
-    root->GenUniformGrid2D(noise.data(), 0, 0, _width, _height, _frequency, _frequency, _seed);
-
-    RGBA32::Vector pixels(noise.size());
-    for (size_t i = 0; i < noise.size(); ++i) {
-        uint8_t const v = static_cast<uint8_t>(
-            std::clamp((noise[i] * 0.5f + 0.5f) * 255.f, 0.f, 255.f));
-        pixels[i] = RGBA32(v, v, v, 255);
+    _setupSlices(params, frames);
+    int const depth = static_cast<int>(frames.size());
+
+    // Every slice is generated & converted in place at once, in the
+    // upload buffer of the first frame
+    GLenum const format = frames.format;
+    size_t const count = static_cast<size_t>(params.width) * static_cast<size_t>(params.height);
+    size_t const total = count * static_cast<size_t>(depth);
+    Frame& first = frames.front();
+    float* noise;
+    if (format == GL_RGBA8) {
+        first.pixels.resize(total);
+        noise = reinterpret_cast<float*>(first.pixels.data());
+    }
+    else {
+        first.blocks.resize(total * sizeof(float));
+        noise = reinterpret_cast<float*>(first.blocks.data());
+    }
+    float const x = static_cast<float>(x_offset) * params.frequency;
+    float const y = static_cast<float>(y_offset) * params.frequency;
+    if (depth > 1) {
+        root->GenUniformGrid3D(noise, x, y, 0.f, params.width, params.height, depth,
+            params.frequency, params.frequency, params.slice_step * params.frequency, params.seed);
+    }
+    else {
+        root->GenUniformGrid2D(noise, x, y, params.width, params.height,
+            params.frequency, params.frequency, params.seed);
+    }
+
+    if (format == GL_RGBA8 && !params.color_ramp.empty()) {
+        std::array<RGBA32, 256> const ramp = makeColorRamp(params.color_ramp);
+        convertNoise(noise, total, format, &ramp);
+    }
+    else
+        convertNoise(noise, total, format);
+
+    // Split slices, which are contiguous (x, then y, then z)
+    if (format == GL_RGBA8) {
+        for (int i = 1; i < depth; ++i) {
+            auto const begin = first.pixels.cbegin() + count * i;
+            frames[i].pixels.assign(begin, begin + count);
+        }
+        first.pixels.resize(count);
+    }
+    else {
+        // R8 texels only take the first quarter of the buffer
+        size_t const bytes = format == GL_R8 ? count : count * sizeof(float);
+        for (int i = 1; i < depth; ++i) {
+            auto const begin = first.blocks.cbegin() + bytes * i;
+            frames[i].blocks.assign(begin, begin + bytes);
+        }
+        first.blocks.resize(bytes);
     }
-    editRawPixels(pixels.data(), _width, _height);
 }
 
 SSS_GL_END;
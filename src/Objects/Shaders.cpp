@@ -72,18 +72,8 @@ void freeShader(const GLuint& pID, const GLuint& shader_id) {
 }
 
 
-// TODO OVERLAOD FOR MORE COMPLEXE SHADERS (COMPUTE...)
-static GLuint loadShaders(std::string const& vertex_data, std::string const& fragment_data)
+static void linkProgram(GLuint program_id)
 {
-	// Link the program
-	GLuint program_id = glCreateProgram();
-	if (program_id == 0) {
-		throw_exc(CONTEXT_MSG("Could not create program", glGetError()));
-	}
-
-	GLuint vertex_shader_id		= attachShader(program_id, GL_VERTEX_SHADER, vertex_data);
-	GLuint fragment_shader_id	= attachShader(program_id, GL_FRAGMENT_SHADER, fragment_data);
-
 	glLinkProgram(program_id);
 
 	// Throw if failed
@@ -98,6 +88,20 @@ static GLuint loadShaders(std::string const& vertex_data, std::string const& fra
 		// Throw
 		throw_exc(FUNC_MSG(CONTEXT_MSG("Could not link program", &msg[0])));
 	}
+}
+
+static GLuint loadShaders(std::string const& vertex_data, std::string const& fragment_data)
+{
+	// Link the program
+	GLuint program_id = glCreateProgram();
+	if (program_id == 0) {
+		throw_exc(CONTEXT_MSG("Could not create program", glGetError()));
+	}
+
+	GLuint vertex_shader_id		= attachShader(program_id, GL_VERTEX_SHADER, vertex_data);
+	GLuint fragment_shader_id	= attachShader(program_id, GL_FRAGMENT_SHADER, fragment_data);
+
+	linkProgram(program_id);
 
 	freeShader(program_id, vertex_shader_id);
 	freeShader(program_id, fragment_shader_id);
@@ -106,6 +110,24 @@ static GLuint loadShaders(std::string const& vertex_data, std::string const& fra
 	return program_id;
 }
 
+static GLuint loadComputeShader(std::string const& compute_data)
+{
+	// Link the program
+	GLuint program_id = glCreateProgram();
+	if (program_id == 0) {
+		throw_exc(CONTEXT_MSG("Could not create program", glGetError()));
+	}
+
+	GLuint compute_shader_id = attachShader(program_id, GL_COMPUTE_SHADER, compute_data);
+
+	linkProgram(program_id);
+
+	freeShader(program_id, compute_shader_id);
+
+	// Return newly created & linked program
+	return program_id;
+}
+
 
 
 
@@ -154,6 +176,29 @@ void Shaders::loadFromStrings(std::string const& vertex_data, std::string const&
 	}
 }
 
+void Shaders::loadComputeFromString(std::string const& compute_data)
+{
+	try 
+	{
+		_program_id		= loadComputeShader(compute_data);
+		_compute_data	= compute_data;
+	}
+	catch (...) 
+	{
+		EMIT_EVENT("SSS_SHADERS_ERROR");
+		LOG_ERR("Error while loading compute shader");
+		return;
+	}
+
+
+	_loaded = true;
+
+	// Log
+	if (Log::GL::Shaders::query(Log::GL::Shaders::get().loading)) {
+		LOG_GL_MSG("Shaders -> loaded (compute)");
+	}
+}
+
 void Shaders::loadFromFiles(std::filesystem::path const& vertex_fp, std::filesystem::path const& fragment_fp) try
 {
 	loadFromStrings(readFile(vertex_fp), readFile(fragment_fp));
@@ -207,6 +252,15 @@ void Shaders::use() const
 	glUseProgram(_program_id);
 }
 
+void Shaders::dispatch(GLuint groups_x, GLuint groups_y, GLuint groups_z) const
+{
+	if (!_loaded || _compute_data.empty()) {
+		LOG_METHOD_WRN("No compute shader was loaded!");
+		return;
+	}
+	glDispatchCompute(groups_x, groups_y, groups_z);
+}
+
 // Return the location of a uniform variable for this program
 GLint Shaders::getUniformLocation(std::string const& name) const
 {
@@ -0,0 +1,211 @@
+#include "GL/Objects/StreamedTexture.hpp"
+
+#include <algorithm>
+
+SSS_GL_BEGIN;
+
+StreamedTexture::StreamedTexture(uint32_t ring_size)
+    : Texture(), _ring_size(std::max<uint32_t>(ring_size, 2))
+{
+    _observe(_decoding_thread);
+}
+
+StreamedTexture::~StreamedTexture() = default;
+
+StreamedTexture::Shared StreamedTexture::create(std::string const& filepath, uint32_t ring_size)
+{
+    Shared ret(new StreamedTexture(ring_size));
+    ret->loadStream(filepath);
+    return ret;
+}
+
+void StreamedTexture::loadStream(std::string const& filepath)
+{
+    std::string const folder = getResourceFolder();
+    std::string path;
+    if (path = folder + filepath; folder.empty() || !pathIsFile(path)) {
+        if (path = pathWhich(filepath); !pathIsFile(path)) {
+            throw_exc(CONTEXT_MSG("Found no file for given arguments", filepath));
+        }
+    }
+    _decoding_thread.run(path, 0, _ring_size);
+}
+
+void StreamedTexture::_subjectUpdate(Subject const& subject, Event const& event)
+{
+    if (!subject.is<_AsyncDecoding>()) {
+        Texture::_subjectUpdate(subject, event);
+        return;
+    }
+
+    // A new file was opened, set up frames and ring layers
+    std::vector<_internal::APNGFrame>& scanned = _decoding_thread._scanned;
+    if (!scanned.empty()) {
+        Frame::Vector frames(scanned.size());
+        frames.w = scanned[0].w;
+        frames.h = scanned[0].h;
+        uint32_t const ring = std::min(_ring_size, static_cast<uint32_t>(frames.size()));
+        for (uint32_t i = 0; i < frames.size(); ++i) {
+            Frame& frame = frames[i];
+            if (scanned[i].delay_den > 0) {
+                frame.delay = std::chrono::nanoseconds(static_cast<int64_t>(1e9
+                    * static_cast<double>(scanned[i].delay_num)
+                    / static_cast<double>(scanned[i].delay_den)
+                    ));
+            }
+            else
+                frame.delay = std::chrono::milliseconds(16);
+            frames.total_time += frame.delay;
+        }
+        frames.layers.resize(ring);
+        for (uint32_t i = 0; i < ring; ++i) {
+            frames.layers[i] = i;
+        }
+        scanned.clear();
+
+        _frames = std::move(frames);
+        _slots.assign(ring, UINT32_MAX);
+        _playback = 0;
+        _remapPending();
+        // Allocates the ring layers, pixels are uploaded below
+        _internalEdit(Type::Raw);
+        EMIT_EVENT("SSS_TEXTURE_LOADED");
+    }
+
+    // Upload decoded frames which are still needed
+    for (auto& [frame, pixels] : _decoding_thread._decoded) {
+        if (frame < _frames.size() && _inWindow(frame)) {
+            _upload(frame, std::move(pixels));
+        }
+    }
+    _decoding_thread._decoded.clear();
+    // Frames moved to other layers, planes need to know
+    if (_remapPending()) {
+        EMIT_EVENT("SSS_TEXTURE_CONTENT");
+    }
+
+    _decodeAhead();
+}
+
+void StreamedTexture::_frameRequested(uint32_t frame)
+{
+    _playback = frame;
+    _decodeAhead();
+}
+
+void StreamedTexture::_decodeAhead()
+{
+    if (_slots.empty() || _decoding_thread.isRunning()) {
+        return;
+    }
+    uint32_t const count = static_cast<uint32_t>(_frames.size());
+    uint32_t const ring = static_cast<uint32_t>(_slots.size());
+    for (uint32_t i = 0; i < ring; ++i) {
+        uint32_t const frame = (_playback + i) % count;
+        if (_slots[_frames[frame].layer] != frame) {
+            _decoding_thread.run(std::string(), frame, ring - i);
+            return;
+        }
+    }
+}
+
+void StreamedTexture::_upload(uint32_t frame, RGBA32::Vector&& pixels)
+{
+    if (_slots[_frames[frame].layer] == frame) {
+        return;
+    }
+    // The window holds as many frames as there are layers, so one
+    // of them is necessarily free if the given frame isn't resident.
+    for (uint32_t layer = 0; layer < _slots.size(); ++layer) {
+        uint32_t const held = _slots[layer];
+        if (held != UINT32_MAX) {
+            if (_inWindow(held))
+                continue;
+            _frames[held].pixels = RGBA32::Vector();
+        }
+        _slots[layer] = frame;
+        _frames.layers[layer] = frame;
+        _frames[frame].layer = layer;
+        _frames[frame].pixels = std::move(pixels);
+        // Evicted layers are restored from _frames on the next bind()
+        if (!_raw_texture.isReleased())
+            _raw_texture.editPixels(_frames[frame].pixels.data(), layer);
+        return;
+    }
+}
+
+bool StreamedTexture::_remapPending()
+{
+    uint32_t const count = static_cast<uint32_t>(_frames.size());
+    auto const resident = [this](uint32_t frame) {
+        return _slots[_frames[frame].layer] == frame;
+    };
+    // Start from any resident frame, so that every pending frame has one before it
+    uint32_t start = 0;
+    while (start < count && !resident(start))
+        ++start;
+
+    bool changed = false;
+    uint32_t fallback = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t const frame = (start + i) % count;
+        if (start != count && resident(frame)) {
+            fallback = _frames[frame].layer;
+            continue;
+        }
+        changed |= _frames[frame].layer != fallback;
+        _frames[frame].layer = fallback;
+    }
+    return changed;
+}
+
+bool StreamedTexture::_inWindow(uint32_t frame) const noexcept
+{
+    uint32_t const count = static_cast<uint32_t>(_frames.size());
+    return count != 0 && (frame + count - _playback) % count < _slots.size();
+}
+
+void StreamedTexture::_AsyncDecoding::_asyncFunction(std::string path, uint32_t first, uint32_t count)
+{
+    _decoded.clear();
+
+    // New file, read every frame delay without decoding anything
+    if (!path.empty()) {
+        _scanned.clear();
+        if (_internal::scan_apng(path.c_str(), _scanned) < 0) {
+            throw_exc(CONTEXT_MSG("scan_apng error", path));
+        }
+        _path = path;
+        _reader.close();
+        _frame_count = static_cast<uint32_t>(_scanned.size());
+        // Forces the reader to be opened below
+        _position = _frame_count;
+    }
+    if (_frame_count == 0) {
+        return;
+    }
+
+    count = std::min(count, _frame_count);
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t const frame = (first + i) % _frame_count;
+        // Frames are composed over one another, and thus can only be
+        // decoded in order: rewind when going back.
+        if (frame < _position) {
+            if (!_reader.open(_path.c_str())) {
+                throw_exc(CONTEXT_MSG("Invalid PNG file", _path));
+            }
+            _position = 0;
+        }
+        while (_position <= frame) {
+            if (_beingCanceled()) return;
+            if (!_reader.next(_scratch)) {
+                throw_exc(CONTEXT_MSG("Missing frame", _path));
+            }
+            ++_position;
+        }
+        uint32_t const* p = reinterpret_cast<uint32_t const*>(_scratch.vec.data());
+        _decoded.emplace_back(frame, RGBA32::Vector(p, p + (_scratch.w * _scratch.h)));
+    }
+}
+
+SSS_GL_END;
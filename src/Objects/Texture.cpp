@@ -1,8 +1,11 @@
 #include "GL/Objects/Texture.hpp"
 #include "GL/Objects/Models/Plane.hpp"
+#include "GL/Window.hpp"
 
 #include <FastNoise/FastNoise.h>
 #include <algorithm>
+#include <cstring>
+#include <unordered_map>
 
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #pragma warning(suppress : 4996)
@@ -15,6 +18,30 @@
 SSS_GL_BEGIN;
 
 std::string Texture::_resource_folder;
+bool Texture::_compressed_variants{ false };
+std::set<Texture*> Texture::_registry;
+size_t Texture::_memory_budget{ 0 };
+uint64_t Texture::_poll_count{ 0 };
+uint64_t Texture::_evictions{ 0 };
+uint64_t Texture::_restorations{ 0 };
+
+// Precompressed variants looked up by loadImage(), by order of preference.
+// ETC2 comes last, as desktop drivers tend to decompress it on upload.
+static std::pair<char const*, GLenum> const compressed_variants[] = {
+    { ".bc7.ktx2",  GL_COMPRESSED_RGBA_BPTC_UNORM },
+    { ".bc3.ktx2",  GL_COMPRESSED_RGBA_S3TC_DXT5_EXT },
+    { ".etc2.ktx2", GL_COMPRESSED_RGBA8_ETC2_EAC }
+};
+
+// Removes the extension of given path, if any
+static std::string remove_extension(std::string const& path)
+{
+    size_t const pos = path.find_last_of("./\\");
+    if (pos == std::string::npos || path[pos] != '.') {
+        return path;
+    }
+    return path.substr(0, pos);
+}
 
 
 void Texture::_register()
@@ -38,8 +65,10 @@ Texture::Texture() try
     _frames.total_time = std::chrono::nanoseconds(0);
     _frames.w = 0;
     _frames.h = 0;
+    _frames.deduplicate();
 
     _observe(_loading_thread);
+    _registry.insert(this);
 
     // Log
     if (Log::GL::Texture::query(Log::GL::Texture::get().life_state)) {
@@ -50,6 +79,7 @@ CATCH_AND_RETHROW_METHOD_EXC;
 
 Texture::~Texture()
 {
+    _registry.erase(this);
     // Log
     if (Log::GL::Texture::query(Log::GL::Texture::get().life_state)) {
         LOG_GL_MSG("Texture -> deleted");
@@ -84,20 +114,50 @@ Texture::Shared Texture::createCellularNoise(int width, int height, float freque
     // with the xStepSize/yStepSize below and make `frequency` ~100x weaker
     // than expected. Neutralize it so `frequency` is the only frequency knob.
     fnGenerator->SetScale(1.0f);
-    std::vector<float> noise(static_cast<size_t>(width) * static_cast<size_t>(height));
-    fnGenerator->GenUniformGrid2D(noise.data(), 0, 0, width, height, frequency, frequency, seed);
-
-    RGBA32::Vector pixels(noise.size());
-    for (size_t i = 0; i < noise.size(); ++i) {
-        uint8_t const v = static_cast<uint8_t>(std::clamp((noise[i] * 0.5f + 0.5f) * 255.f, 0.f, 255.f));
-        pixels[i] = RGBA32(v, v, v, 255);
-    }
+    // Noise is generated & converted in place, in the upload buffer
+    RGBA32::Vector pixels(static_cast<size_t>(width) * static_cast<size_t>(height));
+    float* const noise = reinterpret_cast<float*>(pixels.data());
+    fnGenerator->GenUniformGrid2D(noise, 0, 0, width, height, frequency, frequency, seed);
+    convertNoise(noise, pixels.size());
 
     Shared ret = create();
-    ret->editRawPixels(pixels.data(), width, height);
+    ret->editRawPixels(std::move(pixels), width, height);
     return ret;
 }
 
+void Texture::convertToKTX2(std::string const& src, std::string const& dst,
+    Compression compression) try
+{
+    // Frames are kept as is, identical ones included
+    _AsyncLoading loader;
+    loader._load(src);
+    Frame::Vector const& frames = loader._frames;
+    if (frames.format != GL_RGBA8) {
+        throw_exc(CONTEXT_MSG("Source is already compressed", src));
+    }
+
+    _internal::KTX2Image image;
+    image.format = compression == Compression::BC7
+        ? GL_COMPRESSED_RGBA_BPTC_UNORM : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    image.w = static_cast<unsigned int>(frames.w);
+    image.h = static_cast<unsigned int>(frames.h);
+    image.layers.reserve(frames.size());
+    for (Frame const& frame : frames) {
+        uint8_t const* rgba = reinterpret_cast<uint8_t const*>(frame.pixels.data());
+        if (compression == Compression::BC7)
+            _internal::encode_bc7(rgba, image.w, image.h, image.layers.emplace_back());
+        else
+            _internal::encode_bc3(rgba, image.w, image.h, image.layers.emplace_back());
+        if (frames.size() > 1)
+            image.delays.push_back(frame.delay.count());
+    }
+
+    if (_internal::save_ktx2(dst.c_str(), image) < 0) {
+        throw_exc(CONTEXT_MSG("Could not write KTX2 file", dst));
+    }
+}
+CATCH_AND_RETHROW_FUNC_EXC;
+
 void Texture::setType(Type type) noexcept
 {
     if (_type != type)
@@ -155,9 +215,12 @@ void Texture::editRawPixels(void const* pixels, int width, int height) try
     }
     _frames.w = width;
     _frames.h = height;
+    _frames.format = GL_RGBA8;
     // Replace previous pixel storage
     uint32_t const* ptr = reinterpret_cast<uint32_t const*>(pixels);
     _frames[0].pixels = RGBA32::Vector(ptr, ptr + (width * height));
+    _frames[0].blocks.clear();
+    _frames.deduplicate();
 
     // Update plane type and scaling
     _internalEdit(Type::Raw);
@@ -169,6 +232,102 @@ void Texture::editRawPixels(void const* pixels, int width, int height) try
 }
 CATCH_AND_RETHROW_METHOD_EXC;
 
+void Texture::editRawPixels(RGBA32::Vector&& pixels, int width, int height) try
+{
+    if (pixels.size() != static_cast<size_t>(width) * static_cast<size_t>(height)) {
+        throw_exc(CONTEXT_MSG("Pixel count doesn't match dimensions", pixels.size()));
+    }
+    if (_frames.size() != 1) {
+        _frames.resize(1);
+    }
+    _frames.w = width;
+    _frames.h = height;
+    _frames.format = GL_RGBA8;
+    _frames[0].pixels = std::move(pixels);
+    _frames[0].blocks.clear();
+    _frames.deduplicate();
+
+    // Update plane type and scaling
+    _internalEdit(Type::Raw);
+
+    // Log
+    if (Log::GL::Texture::query(Log::GL::Texture::get().edit)) {
+        LOG_GL_MSG("Texture -> edit");
+    }
+}
+CATCH_AND_RETHROW_METHOD_EXC;
+
+void Texture::editRawTexels(std::vector<uint8_t>&& texels, int width, int height, GLenum format) try
+{
+    if (Basic::Texture::compressedSize(format, 1, 1) != 0) {
+        throw_exc(CONTEXT_MSG("Compressed formats aren't handled", format));
+    }
+    GLenum pixel_format, type;
+    size_t const texel_size = Basic::Texture::texelFormat(format, pixel_format, type);
+    if (texels.size() != static_cast<size_t>(width) * static_cast<size_t>(height) * texel_size) {
+        throw_exc(CONTEXT_MSG("Texel count doesn't match dimensions", texels.size()));
+    }
+    if (pixel_format == GL_RGBA) {
+        editRawPixels(texels.data(), width, height);
+        return;
+    }
+    if (_frames.size() != 1) {
+        _frames.resize(1);
+    }
+    _frames.w = width;
+    _frames.h = height;
+    _frames.format = format;
+    _frames[0].pixels = RGBA32::Vector();
+    _frames[0].blocks = std::move(texels);
+    _frames[0].alpha_mask.clear();
+    _frames.deduplicate();
+
+    // Update plane type and scaling
+    _internalEdit(Type::Raw);
+
+    // Log
+    if (Log::GL::Texture::query(Log::GL::Texture::get().edit)) {
+        LOG_GL_MSG("Texture -> edit");
+    }
+}
+CATCH_AND_RETHROW_METHOD_EXC;
+
+void Texture::setKeepPixels(bool keep)
+{
+    _keep_pixels = keep;
+    // Evicted pixels are released once restored
+    if (!_keep_pixels && _type == Type::Raw && isResident())
+        _frames.releasePixels();
+}
+
+bool Texture::isOpaque(size_t frame, int x, int y) const
+{
+    if (x < 0 || y < 0) {
+        return false;
+    }
+    if (_type == Type::Text) {
+        if (!_area)
+            return false;
+        int w, h;
+        _area->pixelsGetDimensions(w, h);
+        if (x >= w || y >= h)
+            return false;
+        void const* pixels = _area->pixelsGet();
+        return static_cast<RGBA32 const*>(pixels)[y * w + x].a != 0;
+    }
+
+    if (frame >= _frames.size() || x >= _frames.w || y >= _frames.h) {
+        return false;
+    }
+    Frame const& owner = _frames[_frames.layers.at(_frames[frame].layer)];
+    size_t const pixel = static_cast<size_t>(y) * static_cast<size_t>(_frames.w) + x;
+    if (!owner.pixels.empty())
+        return owner.pixels[pixel].a != 0;
+    if (!owner.alpha_mask.empty())
+        return (owner.alpha_mask[pixel / 64] >> (pixel % 64)) & 1;
+    return !owner.blocks.empty();
+}
+
 void Texture::setColor(RGBA32 color)
 {
     editRawPixels(&color, 1, 1);
@@ -234,17 +393,88 @@ void Texture::_subjectUpdate(Subject const& subject, Event const& event)
 }
 
 void Texture::_AsyncLoading::_asyncFunction(std::string folder, std::string filepath)
+{
+    std::string path;
+    if (path = folder + filepath; folder.empty() || !pathIsFile(path)) {
+        if (path = pathWhich(filepath); !pathIsFile(path)) {
+            throw_exc(CONTEXT_MSG("Found no file for given arguments", filepath));
+        }
+    }
+
+    // Prefer a precompressed variant the driver can sample
+    if (_compressed_variants && !path.ends_with(".ktx2")) {
+        std::string const stem = remove_extension(path);
+        for (auto const& [variant, format] : compressed_variants) {
+            if (Window::isCompressedFormatSupported(format) && pathIsFile(stem + variant)) {
+                path = stem + variant;
+                break;
+            }
+        }
+    }
+
+    _load(path);
+
+    // Share GPU layers between identical frames
+    if (_beingCanceled()) return;
+    _frames.deduplicate();
+}
+
+void Texture::_AsyncLoading::_load(std::string const& path)
 {
     _frames.clear();
     _frames.total_time = std::chrono::nanoseconds(0);
     _frames.w = 0;
     _frames.h = 0;
+    _frames.format = GL_RGBA8;
 
-    std::string path;
-    if (path = folder + filepath; folder.empty() || !pathIsFile(path)) {
-        if (path = pathWhich(filepath); !pathIsFile(path)) {
-            throw_exc(CONTEXT_MSG("Found no file for given arguments", filepath));
+    // KTX2 files hold GPU-ready (possibly compressed) layers
+    if (path.ends_with(".ktx2")) {
+        _internal::KTX2Image image;
+        if (_internal::load_ktx2(path.c_str(), image) < 0) {
+            SSS::throw_exc(CONTEXT_MSG("load_ktx2 error", path));
+        }
+        // Fall back to the uncompressed source if the driver can't sample this format
+        if (image.format != GL_RGBA8 && !Window::isCompressedFormatSupported(image.format)) {
+            std::string stem = remove_extension(path);
+            for (auto const& [variant, format] : compressed_variants) {
+                std::string_view const tag(variant, std::strlen(variant) - 5);
+                if (stem.ends_with(tag)) {
+                    stem.resize(stem.size() - tag.size());
+                    break;
+                }
+            }
+            if (!pathIsFile(stem + ".png")) {
+                SSS::throw_exc(CONTEXT_MSG("Unsupported compressed format, and no PNG fallback", path));
+            }
+            _load(stem + ".png");
+            return;
         }
+        _frames.w = static_cast<int>(image.w);
+        _frames.h = static_cast<int>(image.h);
+        _frames.format = image.format;
+        _frames.reserve(image.layers.size());
+        for (size_t i = 0; i < image.layers.size(); ++i) {
+            if (_beingCanceled()) return;
+            auto& frame = _frames.emplace_back();
+            if (image.format == GL_RGBA8) {
+                uint32_t const* p = reinterpret_cast<uint32_t const*>(image.layers[i].data());
+                frame.pixels = RGBA32::Vector(p, p + (_frames.w * _frames.h));
+            }
+            else {
+                frame.blocks = std::move(image.layers[i]);
+                // Alpha hitboxes can't read compressed blocks
+                _internal::decode_alpha_mask(image.format, frame.blocks.data(),
+                    image.w, image.h, frame.alpha_mask);
+            }
+            // Single images have no delay, as with stb_image.
+            // Negative delays are defaulted, as invalid APNG delays.
+            if (i < image.delays.size() && image.delays[i] >= 0)
+                frame.delay = std::chrono::nanoseconds(image.delays[i]);
+            else if (image.layers.size() > 1)
+                frame.delay = std::chrono::milliseconds(16);
+            _frames.total_time += frame.delay;
+        }
+        return;
     }
 
     // Check if filepath ends with ".png"
@@ -252,11 +482,11 @@ void Texture::_AsyncLoading::_asyncFunction(std::string folder, std::string file
     // Else, use stbi functions
     static const std::string png(".png");
     // Ends with ".png"
-    if (filepath.compare(filepath.length() - png.length(), png.length(), png) == 0) {
+    if (path.ends_with(png)) {
         // Load frames
         std::vector<_internal::APNGFrame> apng_frames;
         if (load_apng(path.c_str(), apng_frames) < 0) {
-            SSS::throw_exc(CONTEXT_MSG("load_apng error", filepath));
+            SSS::throw_exc(CONTEXT_MSG("load_apng error", path));
         }
         // Copy data
         if (!apng_frames.empty()) {
@@ -298,7 +528,7 @@ void Texture::_AsyncLoading::_asyncFunction(std::string folder, std::string file
             )));
         // Throw if error
         if (raw_pixels == nullptr) {
-            SSS::throw_exc(CONTEXT_MSG(stbi_failure_reason(), filepath));
+            SSS::throw_exc(CONTEXT_MSG(stbi_failure_reason(), path));
         }
         // Fill vector
         if (_beingCanceled()) return;
@@ -307,39 +537,245 @@ void Texture::_AsyncLoading::_asyncFunction(std::string folder, std::string file
     }
 }
 
+void Texture::Frame::Vector::deduplicate()
+{
+    layers.clear();
+    if (size() == 1) {
+        front().layer = 0;
+        layers.push_back(0);
+        return;
+    }
+
+    // Compressed frames are compared by their blocks
+    auto const bytes = [this](Frame const& frame) {
+        if (format != GL_RGBA8) {
+            return std::string_view(reinterpret_cast<char const*>(frame.blocks.data()),
+                frame.blocks.size());
+        }
+        return std::string_view(reinterpret_cast<char const*>(frame.pixels.data()),
+            frame.pixels.size() * sizeof(RGBA32));
+    };
+
+    // Frames are bucketed by pixel hash, then compared byte per byte
+    // to be safe from hash collisions.
+    std::unordered_multimap<size_t, uint32_t> hashes;
+    hashes.reserve(size());
+    for (uint32_t i = 0; i < size(); ++i) {
+        Frame& frame = (*this)[i];
+        std::string_view const data = bytes(frame);
+        size_t const hash = std::hash<std::string_view>{}(data);
+
+        frame.layer = static_cast<uint32_t>(layers.size());
+        auto [it, end] = hashes.equal_range(hash);
+        for (; it != end; ++it) {
+            std::string_view const other = bytes((*this)[layers[it->second]]);
+            if (other.size() == data.size()
+                && std::memcmp(other.data(), data.data(), data.size()) == 0)
+            {
+                frame.layer = it->second;
+                break;
+            }
+        }
+
+        if (frame.layer == layers.size()) {
+            hashes.emplace(hash, frame.layer);
+            layers.push_back(i);
+        }
+        else {
+            // Duplicate, its pixels are held by the layer's owner
+            frame.pixels = RGBA32::Vector();
+            frame.blocks = std::vector<uint8_t>();
+            frame.alpha_mask = std::vector<uint64_t>();
+        }
+    }
+}
+
+void Texture::Frame::Vector::releasePixels()
+{
+    size_t const pixel_count = static_cast<size_t>(w) * static_cast<size_t>(h);
+    for (uint32_t const owner : layers) {
+        Frame& frame = (*this)[owner];
+        if (!frame.pixels.empty()) {
+            frame.alpha_mask.assign((frame.pixels.size() + 63) / 64, 0);
+            for (size_t i = 0; i < frame.pixels.size(); ++i) {
+                if (frame.pixels[i].a != 0)
+                    frame.alpha_mask[i / 64] |= uint64_t(1) << (i % 64);
+            }
+            frame.pixels = RGBA32::Vector();
+        }
+        else if (!frame.blocks.empty()) {
+            // Decoded when loaded, see isOpaque(). Others are opaque.
+            if (frame.alpha_mask.empty())
+                frame.alpha_mask.assign((pixel_count + 63) / 64, ~uint64_t(0));
+            frame.blocks = std::vector<uint8_t>();
+        }
+    }
+}
+
+void Texture::Frame::Vector::computeTimings()
+{
+    end_times.resize(size());
+    std::chrono::nanoseconds time(0);
+    for (size_t i = 0; i < size(); ++i) {
+        time += (*this)[i].delay;
+        end_times[i] = time;
+    }
+    total_time = time;
+}
+
+uint32_t Texture::Frame::Vector::frameAt(std::chrono::nanoseconds time) const noexcept
+{
+    if (end_times.empty()) {
+        return 0;
+    }
+    // First frame ending after given time
+    auto const it = std::upper_bound(end_times.cbegin(), end_times.cend(), time);
+    if (it == end_times.cend()) {
+        return static_cast<uint32_t>(end_times.size() - 1);
+    }
+    return static_cast<uint32_t>(it - end_times.cbegin());
+}
+
 void Texture::_internalEdit(Type type)
+{
+    _notifyEdit(_internalEditQuiet(type));
+}
+
+bool Texture::_internalEditQuiet(Type type)
 {
     _type = type;
+    return _internalUpload();
+}
+
+void Texture::_notifyEdit(bool resized)
+{
+    if (resized) {
+        EMIT_EVENT("SSS_TEXTURE_RESIZE");
+    }
+
+    if (_callback_f)
+        _callback_f(*this);
+
+    EMIT_EVENT("SSS_TEXTURE_CONTENT"); 
+    // Log
+    if (Log::GL::Texture::query(Log::GL::Texture::get().edit)) {
+        LOG_GL_MSG("Texture -> edit");
+    }
+}
+
+bool Texture::_internalUpload()
+{
+    bool resized = false;
     if (_type == Type::Raw) {
-        if (_raw_texture.editSettings(_frames.w, _frames.h, static_cast<int>(_frames.size())))
-        {
-            EMIT_EVENT("SSS_TEXTURE_RESIZE");
-        }
-        for (uint32_t i = 0; i < _frames.size(); ++i) {
-            _raw_texture.editPixels(_frames[i].pixels.data(), i);
+        _frames.computeTimings();
+        // Only unique frames are uploaded, see Frame::Vector::deduplicate()
+        resized = _raw_texture.editSettings(_frames.w, _frames.h,
+            static_cast<int>(_frames.layers.size()), _frames.format);
+        bool const compressed = Basic::Texture::compressedSize(_frames.format, 1, 1) != 0;
+        for (uint32_t i = 0; i < _frames.layers.size(); ++i) {
+            Frame const& frame = _frames[_frames.layers[i]];
+            // Layers may be filled later on (eg: StreamedTexture)
+            if (!frame.blocks.empty() && compressed) {
+                _raw_texture.editCompressedPixels(frame.blocks.data(),
+                    static_cast<GLsizei>(frame.blocks.size()), i);
+            }
+            else if (!frame.blocks.empty())
+                _raw_texture.editPixels(frame.blocks.data(), i);
+            else if (!frame.pixels.empty())
+                _raw_texture.editPixels(frame.pixels.data(), i);
         }
+        if (!_keep_pixels)
+            _frames.releasePixels();
     }
     else if (_type == Type::Text) {
         int w = 0, h = 0;
         if (_area)
             _area->pixelsGetDimensions(w, h);
-        if (_raw_texture.editSettings(w, h))
-        {
-            EMIT_EVENT("SSS_TEXTURE_RESIZE");
-        }
+        resized = _raw_texture.editSettings(w, h);
         if (_area)
             _raw_texture.editPixels(_area->pixelsGet());
     }
+    // Single-channel textures are sampled as grayscale
+    bool const gray = _type == Type::Raw && (_frames.format == GL_R8 || _frames.format == GL_R32F);
+    _raw_texture.parameteri(GL_TEXTURE_SWIZZLE_G, gray ? GL_RED : GL_GREEN);
+    _raw_texture.parameteri(GL_TEXTURE_SWIZZLE_B, gray ? GL_RED : GL_BLUE);
+    return resized;
+}
 
-    if (_callback_f)
-        _callback_f(*this);
+void Texture::bind()
+{
+    _last_bound = _poll_count;
+    // Restore evicted storage, observers aren't notified as nothing changed
+    if (_raw_texture.isReleased()) {
+        _internalUpload();
+        ++_restorations;
+    }
+    _raw_texture.bind();
+}
 
-    EMIT_EVENT("SSS_TEXTURE_CONTENT"); 
-    // Log
-    if (Log::GL::Texture::query(Log::GL::Texture::get().edit)) {
-        LOG_GL_MSG("Texture -> edit");
+Texture::MemoryStats Texture::getMemoryStats() noexcept
+{
+    MemoryStats stats;
+    stats.budget = _memory_budget;
+    stats.allocated_bytes = Basic::Texture::getAllocatedBytes();
+    for (Texture const* texture : _registry) {
+        if (texture->isResident()) {
+            stats.resident_bytes += texture->_raw_texture.getByteSize();
+            ++stats.resident_count;
+        }
+        else {
+            stats.evicted_bytes += texture->_raw_texture.getReleasedByteSize();
+            ++stats.evicted_count;
+        }
     }
+    stats.evictions = _evictions;
+    stats.restorations = _restorations;
+    return stats;
 }
 
+bool Texture::_isEvictable() const noexcept
+{
+    if (_raw_texture.isReleased() || _raw_texture.getByteSize() == 0) {
+        return false;
+    }
+    if (_type == Type::Text) {
+        return _area != nullptr;
+    }
+    // Every layer needs its pixels to be restored
+    for (uint32_t const owner : _frames.layers) {
+        if (_frames[owner].pixels.empty() && _frames[owner].blocks.empty())
+            return false;
+    }
+    return true;
+}
+
+void Texture::_enforceBudget()
+{
+    if (_memory_budget != 0) {
+        size_t resident = 0;
+        for (Texture const* texture : _registry) {
+            resident += texture->_raw_texture.getByteSize();
+        }
+        if (resident > _memory_budget) {
+            // Textures bound since the last poll are still in use
+            std::vector<Texture*> candidates;
+            for (Texture* texture : _registry) {
+                if (texture->_last_bound != _poll_count && texture->_isEvictable())
+                    candidates.push_back(texture);
+            }
+            std::sort(candidates.begin(), candidates.end(), [](Texture const* a, Texture const* b) {
+                return a->_last_bound < b->_last_bound;
+            });
+            for (Texture* texture : candidates) {
+                if (resident <= _memory_budget)
+                    break;
+                resident -= texture->_raw_texture.getByteSize();
+                texture->_raw_texture.release();
+                ++_evictions;
+            }
+        }
+    }
+    ++_poll_count;
+}
 
 SSS_GL_END;
\ No newline at end of file
@@ -143,7 +143,7 @@ static void processing_start(png_structp& png_ptr, png_infop& info_ptr, void* fr
             png_process_data(png_ptr, info_ptr, chunksInfo[i].vec.data(), chunksInfo[i].size);
 }
 
-static void processing_data(png_structp png_ptr, png_infop info_ptr, uint8_t* p, unsigned int size)
+static void processing_data(png_structp& png_ptr, png_infop& info_ptr, uint8_t* p, unsigned int size)
 {
     if (!png_ptr || !info_ptr)
         return;
@@ -157,7 +157,7 @@ static void processing_data(png_structp png_ptr, png_infop info_ptr, uint8_t* p,
     png_process_data(png_ptr, info_ptr, p, size);
 }
 
-static int processing_finish(png_structp png_ptr, png_infop info_ptr)
+static int processing_finish(png_structp& png_ptr, png_infop& info_ptr)
 {
     uint8_t footer[12] = { 0, 0, 0, 0, 73, 69, 78, 68, 174, 66, 96, 130 };
 
@@ -176,169 +176,301 @@ static int processing_finish(png_structp png_ptr, png_infop info_ptr)
     return 0;
 }
 
-int load_apng(char const* filepath, std::vector<APNGFrame>& frames)
+// Copies the composed frame, without its row pointers
+static void output_frame(APNGFrame& dst, APNGFrame const& src)
 {
-    FILE* f;
-    unsigned int id, w, h, w0, h0, x0, y0;
-    unsigned int delay_num, delay_den, dop, bop, rowbytes, imagesize;
-    uint8_t sig[8];
-    png_structp png_ptr;
-    png_infop info_ptr;
+    dst.vec = src.vec;
+    dst.rows.clear();
+    dst.w = src.w;
+    dst.h = src.h;
+    dst.delay_num = src.delay_num;
+    dst.delay_den = src.delay_den;
+}
+
+struct APNGReader::_State {
+    FILE* f{ nullptr };
+    unsigned int w{ 0 }, h{ 0 }, w0{ 0 }, h0{ 0 }, x0{ 0 }, y0{ 0 };
+    unsigned int delay_num{ 1 }, delay_den{ 10 }, dop{ 0 }, bop{ 0 }, rowbytes{ 0 }, imagesize{ 0 };
+    png_structp png_ptr{ nullptr };
+    png_infop info_ptr{ nullptr };
     CHUNK chunk;
     CHUNK chunkIHDR;
     std::vector<CHUNK> chunksInfo;
     bool isAnimated = false;
     bool skipFirst = false;
     bool hasInfo = false;
+    bool ended = false;
     APNGFrame frameRaw;
     APNGFrame frameCur;
     APNGFrame frameNext;
-    int res = -1;
+    size_t count{ 0 };
+};
 
-    errno_t err = fopen_s(&f, filepath, "rb");
+APNGReader::APNGReader() = default;
+
+APNGReader::~APNGReader()
+{
+    close();
+}
+
+bool APNGReader::open(char const* filepath)
+{
+    close();
+    _state = std::make_unique<_State>();
+    _State& s = *_state;
+
+    errno_t err = fopen_s(&s.f, filepath, "rb");
     if (err != 0) {
+        _state.reset();
         throw_exc(CONTEXT_MSG(getErrorString(err), filepath));
     }
-    if (fread_s(sig, 8, 1, 8, f) == 8 && png_sig_cmp(sig, 0, 8) == 0)
+
+    uint8_t sig[8];
+    if (fread_s(sig, 8, 1, 8, s.f) != 8 || png_sig_cmp(sig, 0, 8) != 0
+        || read_chunk(s.f, &s.chunkIHDR) != id_IHDR || s.chunkIHDR.size != 25)
+    {
+        close();
+        return false;
+    }
+
+    s.w0 = s.w = png_get_uint_32(s.chunkIHDR.vec.data() + 8);
+    s.h0 = s.h = png_get_uint_32(s.chunkIHDR.vec.data() + 12);
+    s.rowbytes = s.w * 4;
+    s.imagesize = s.h * s.rowbytes;
+
+    s.frameRaw.vec.resize(s.imagesize);
+    s.frameRaw.rows.resize(s.h * sizeof(png_bytep));
+    for (size_t i = 0; i < s.h; i++)
+        s.frameRaw.rows[i] = s.frameRaw.vec.data() + i * s.rowbytes;
+
+    s.frameCur.w = s.w;
+    s.frameCur.h = s.h;
+    s.frameCur.vec.resize(s.imagesize);
+    s.frameCur.rows.resize(s.h * sizeof(png_bytep));
+    for (size_t i = 0; i < s.h; i++)
+        s.frameCur.rows[i] = s.frameCur.vec.data() + i * s.rowbytes;
+
+    processing_start(s.png_ptr, s.info_ptr, (void*)&s.frameRaw, s.hasInfo, s.chunkIHDR, s.chunksInfo);
+    return true;
+}
+
+void APNGReader::close()
+{
+    if (!_state)
+        return;
+    if (_state->png_ptr)
+        png_destroy_read_struct(&_state->png_ptr, &_state->info_ptr, 0);
+    if (_state->f)
+        fclose(_state->f);
+    _state.reset();
+}
+
+bool APNGReader::skipsFirst() const noexcept
+{
+    return _state && _state->skipFirst;
+}
+
+bool APNGReader::next(APNGFrame& frame)
+{
+    if (!_state || _state->ended)
+        return false;
+    _State& s = *_state;
+
+    while (!feof(s.f))
     {
-        id = read_chunk(f, &chunkIHDR);
+        unsigned int id = read_chunk(s.f, &s.chunk);
 
-        if (id == id_IHDR && chunkIHDR.size == 25)
+        if (id == id_acTL && !s.hasInfo && !s.isAnimated)
         {
-            w0 = w = png_get_uint_32(chunkIHDR.vec.data() + 8);
-            h0 = h = png_get_uint_32(chunkIHDR.vec.data() + 12);
-            x0 = 0;
-            y0 = 0;
-            delay_num = 1;
-            delay_den = 10;
-            dop = 0;
-            bop = 0;
-            rowbytes = w * 4;
-            imagesize = h * rowbytes;
-
-            frameRaw.vec.resize(imagesize);
-            frameRaw.rows.resize(h * sizeof(png_bytep));
-            for (size_t i = 0; i < h; i++)
-                frameRaw.rows[i] = frameRaw.vec.data() + i * rowbytes;
-
-            frameCur.w = w;
-            frameCur.h = h;
-            frameCur.vec.resize(imagesize);
-            frameCur.rows.resize(h * sizeof(png_bytep));
-            for (size_t i = 0; i < h; i++)
-                frameCur.rows[i] = frameCur.vec.data() + i * rowbytes;
-
-            processing_start(png_ptr, info_ptr, (void*)&frameRaw, hasInfo, chunkIHDR, chunksInfo);
-
-            while (!feof(f))
+            s.isAnimated = true;
+            s.skipFirst = true;
+        }
+        else
+            if (id == id_fcTL && (!s.hasInfo || s.isAnimated))
             {
-                id = read_chunk(f, &chunk);
-
-                if (id == id_acTL && !hasInfo && !isAnimated)
+                bool produced = false;
+                if (s.hasInfo)
                 {
-                    isAnimated = true;
-                    skipFirst = true;
-                }
-                else
-                    if (id == id_fcTL && (!hasInfo || isAnimated))
+                    if (!processing_finish(s.png_ptr, s.info_ptr))
                     {
-                        if (hasInfo)
-                        {
-                            if (!processing_finish(png_ptr, info_ptr))
-                            {
-                                frameNext.vec.resize(imagesize);
-                                frameNext.rows.resize(h * sizeof(png_bytep));
-                                for (size_t i = 0; i < h; i++)
-                                    frameNext.rows[i] = frameNext.vec.data() + i * rowbytes;
+                        s.frameNext.vec.resize(s.imagesize);
+                        s.frameNext.rows.resize(s.h * sizeof(png_bytep));
+                        for (size_t i = 0; i < s.h; i++)
+                            s.frameNext.rows[i] = s.frameNext.vec.data() + i * s.rowbytes;
 
-                                if (dop == 2)
-                                    frameNext.vec = frameCur.vec;
+                        if (s.dop == 2)
+                            s.frameNext.vec = s.frameCur.vec;
 
-                                compose_frame(frameCur.rows, frameRaw.rows, bop, x0, y0, w0, h0);
-                                frameCur.delay_num = delay_num;
-                                frameCur.delay_den = delay_den;
+                        compose_frame(s.frameCur.rows, s.frameRaw.rows, s.bop, s.x0, s.y0, s.w0, s.h0);
+                        s.frameCur.delay_num = s.delay_num;
+                        s.frameCur.delay_den = s.delay_den;
 
-                                frames.push_back(frameCur);
+                        output_frame(frame, s.frameCur);
+                        ++s.count;
+                        produced = true;
 
-                                if (dop != 2)
-                                {
-                                    frameNext.vec = frameCur.vec;
-                                    if (dop == 1)
-                                        for (size_t i = 0; i < h0; i++)
-                                            std::memset(frameNext.rows[y0 + i] + x0 * 4, 0, w0 * 4);
-                                }
-                                frameCur.vec = std::move(frameNext.vec);
-                                frameCur.rows = std::move(frameNext.rows);
-                            }
-                            else
-                                break;
-                        }
-
-                        // At this point the old frame is done. Let's start a new one.
-                        w0 = png_get_uint_32(chunk.vec.data() + 12);
-                        h0 = png_get_uint_32(chunk.vec.data() + 16);
-                        x0 = png_get_uint_32(chunk.vec.data() + 20);
-                        y0 = png_get_uint_32(chunk.vec.data() + 24);
-                        delay_num = png_get_uint_16(chunk.vec.data() + 28);
-                        delay_den = png_get_uint_16(chunk.vec.data() + 30);
-                        dop = chunk.vec[32];
-                        bop = chunk.vec[33];
-
-                        if (hasInfo)
+                        if (s.dop != 2)
                         {
-                            std::memcpy(chunkIHDR.vec.data() + 8, chunk.vec.data() + 12, 8);
-                            processing_start(png_ptr, info_ptr, (void*)&frameRaw, hasInfo, chunkIHDR, chunksInfo);
+                            s.frameNext.vec = s.frameCur.vec;
+                            if (s.dop == 1)
+                                for (size_t i = 0; i < s.h0; i++)
+                                    std::memset(s.frameNext.rows[s.y0 + i] + s.x0 * 4, 0, s.w0 * 4);
                         }
-                        else
-                            skipFirst = false;
+                        s.frameCur.vec = std::move(s.frameNext.vec);
+                        s.frameCur.rows = std::move(s.frameNext.rows);
+                    }
+                    else
+                        break;
+                }
 
-                        if (frames.size() == (skipFirst ? 1 : 0))
-                        {
-                            bop = 0;
-                            if (dop == 2)
-                                dop = 1;
-                        }
+                // At this point the old frame is done. Let's start a new one.
+                s.w0 = png_get_uint_32(s.chunk.vec.data() + 12);
+                s.h0 = png_get_uint_32(s.chunk.vec.data() + 16);
+                s.x0 = png_get_uint_32(s.chunk.vec.data() + 20);
+                s.y0 = png_get_uint_32(s.chunk.vec.data() + 24);
+                s.delay_num = png_get_uint_16(s.chunk.vec.data() + 28);
+                s.delay_den = png_get_uint_16(s.chunk.vec.data() + 30);
+                s.dop = s.chunk.vec[32];
+                s.bop = s.chunk.vec[33];
+
+                if (s.hasInfo)
+                {
+                    std::memcpy(s.chunkIHDR.vec.data() + 8, s.chunk.vec.data() + 12, 8);
+                    processing_start(s.png_ptr, s.info_ptr, (void*)&s.frameRaw, s.hasInfo, s.chunkIHDR, s.chunksInfo);
+                }
+                else
+                    s.skipFirst = false;
+
+                if (s.count == (s.skipFirst ? 1 : 0))
+                {
+                    s.bop = 0;
+                    if (s.dop == 2)
+                        s.dop = 1;
+                }
+
+                if (produced)
+                    return true;
+            }
+            else
+                if (id == id_IDAT)
+                {
+                    s.hasInfo = true;
+                    processing_data(s.png_ptr, s.info_ptr, s.chunk.vec.data(), s.chunk.size);
+                }
+                else
+                    if (id == id_fdAT && s.isAnimated)
+                    {
+                        png_save_uint_32(s.chunk.vec.data() + 4, s.chunk.size - 16);
+                        std::memcpy(s.chunk.vec.data() + 8, "IDAT", 4);
+                        processing_data(s.png_ptr, s.info_ptr, s.chunk.vec.data() + 4, s.chunk.size - 4);
                     }
                     else
-                        if (id == id_IDAT)
+                        if (id == id_IEND)
                         {
-                            hasInfo = true;
-                            processing_data(png_ptr, info_ptr, chunk.vec.data(), chunk.size);
-                        }
-                        else
-                            if (id == id_fdAT && isAnimated)
+                            s.ended = true;
+                            if (s.hasInfo && !processing_finish(s.png_ptr, s.info_ptr))
                             {
-                                png_save_uint_32(chunk.vec.data() + 4, chunk.size - 16);
-                                std::memcpy(chunk.vec.data() + 8, "IDAT", 4);
-                                processing_data(png_ptr, info_ptr, chunk.vec.data() + 4, chunk.size - 4);
+                                compose_frame(s.frameCur.rows, s.frameRaw.rows, s.bop, s.x0, s.y0, s.w0, s.h0);
+                                s.frameCur.delay_num = s.delay_num;
+                                s.frameCur.delay_den = s.delay_den;
+                                output_frame(frame, s.frameCur);
+                                ++s.count;
+                                return true;
                             }
+                            return false;
+                        }
+                        else
+                            if (notabc(s.chunk.vec[4]) || notabc(s.chunk.vec[5]) || notabc(s.chunk.vec[6]) || notabc(s.chunk.vec[7]))
+                                break;
                             else
-                                if (id == id_IEND)
+                                if (!s.hasInfo)
                                 {
-                                    if (hasInfo && !processing_finish(png_ptr, info_ptr))
-                                    {
-                                        compose_frame(frameCur.rows, frameRaw.rows, bop, x0, y0, w0, h0);
-                                        frameCur.delay_num = delay_num;
-                                        frameCur.delay_den = delay_den;
-                                        frames.push_back(frameCur);
-                                    }
-                                    break;
+                                    processing_data(s.png_ptr, s.info_ptr, s.chunk.vec.data(), s.chunk.size);
+                                    s.chunksInfo.push_back(s.chunk);
+                                    continue;
                                 }
-                                else
-                                    if (notabc(chunk.vec[4]) || notabc(chunk.vec[5]) || notabc(chunk.vec[6]) || notabc(chunk.vec[7]))
-                                        break;
-                                    else
-                                        if (!hasInfo)
-                                        {
-                                            processing_data(png_ptr, info_ptr, chunk.vec.data(), chunk.size);
-                                            chunksInfo.push_back(chunk);
-                                            continue;
-                                        }
+    }
+
+    s.ended = true;
+    return false;
+}
+
+int load_apng(char const* filepath, std::vector<APNGFrame>& frames)
+{
+    APNGReader reader;
+    if (!reader.open(filepath))
+        return -1;
+
+    APNGFrame frame;
+    while (reader.next(frame))
+        frames.push_back(std::move(frame));
+
+    if (frames.empty())
+        return -1;
+    return reader.skipsFirst() ? 0 : 1;
+}
+
+int scan_apng(char const* filepath, std::vector<APNGFrame>& frames)
+{
+    FILE* f;
+    errno_t err = fopen_s(&f, filepath, "rb");
+    if (err != 0) {
+        throw_exc(CONTEXT_MSG(getErrorString(err), filepath));
+    }
+
+    int res = -1;
+    uint8_t sig[8];
+    CHUNK chunk;
+    if (fread_s(sig, 8, 1, 8, f) == 8 && png_sig_cmp(sig, 0, 8) == 0
+        && read_chunk(f, &chunk) == id_IHDR && chunk.size == 25)
+    {
+        // Mirrors the frame outputs of APNGReader::next()
+        APNGFrame pending;
+        pending.w = png_get_uint_32(chunk.vec.data() + 8);
+        pending.h = png_get_uint_32(chunk.vec.data() + 12);
+        pending.delay_num = 1;
+        pending.delay_den = 10;
+        bool isAnimated = false;
+        bool hasInfo = false;
+
+        while (!feof(f))
+        {
+            // Only read the data of fcTL chunks, skip others
+            uint8_t header[8];
+            if (fread(header, 8, 1, f) != 1)
+                break;
+            unsigned int const size = png_get_uint_32(header);
+            unsigned int const id = *(unsigned int*)(header + 4);
+            if (notabc(header[4]) || notabc(header[5]) || notabc(header[6]) || notabc(header[7]))
+                break;
+
+            if (id == id_fcTL && (!hasInfo || isAnimated))
+            {
+                uint8_t data[26];
+                if (size < 26 || fread(data, 26, 1, f) != 1)
+                    break;
+                if (hasInfo)
+                    frames.push_back(pending);
+                pending.delay_num = png_get_uint_16(data + 20);
+                pending.delay_den = png_get_uint_16(data + 22);
+                fseek(f, size - 26 + 4, SEEK_CUR);
+                continue;
             }
 
-            if (!frames.empty())
-                res = (skipFirst) ? 0 : 1;
+            if (id == id_acTL && !hasInfo)
+                isAnimated = true;
+            else if (id == id_IDAT)
+                hasInfo = true;
+            else if (id == id_IEND) {
+                if (hasInfo)
+                    frames.push_back(pending);
+                break;
+            }
+            fseek(f, size + 4, SEEK_CUR);
         }
+
+        if (!frames.empty())
+            res = 1;
     }
     fclose(f);
 
@@ -0,0 +1,726 @@
+#include "GL/Objects/Texture.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <tuple>
+
+SSS_GL_BEGIN;
+INTERNAL_BEGIN;
+
+// Vulkan formats (as stored in KTX2 headers) handled by SSS/GL,
+// sRGB variants are read as their UNORM equivalent.
+static std::pair<uint32_t, GLenum> const vk_formats[] = {
+    { 37,  GL_RGBA8 },                          // R8G8B8A8_UNORM
+    { 43,  GL_RGBA8 },                          // R8G8B8A8_SRGB
+    { 133, GL_COMPRESSED_RGBA_S3TC_DXT1_EXT },  // BC1_RGBA_UNORM_BLOCK
+    { 134, GL_COMPRESSED_RGBA_S3TC_DXT1_EXT },  // BC1_RGBA_SRGB_BLOCK
+    { 137, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT },  // BC3_UNORM_BLOCK
+    { 138, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT },  // BC3_SRGB_BLOCK
+    { 145, GL_COMPRESSED_RGBA_BPTC_UNORM },     // BC7_UNORM_BLOCK
+    { 146, GL_COMPRESSED_RGBA_BPTC_UNORM },     // BC7_SRGB_BLOCK
+    { 147, GL_COMPRESSED_RGB8_ETC2 },           // ETC2_R8G8B8_UNORM_BLOCK
+    { 148, GL_COMPRESSED_RGB8_ETC2 },           // ETC2_R8G8B8_SRGB_BLOCK
+    { 151, GL_COMPRESSED_RGBA8_ETC2_EAC },      // ETC2_R8G8B8A8_UNORM_BLOCK
+    { 152, GL_COMPRESSED_RGBA8_ETC2_EAC }       // ETC2_R8G8B8A8_SRGB_BLOCK
+};
+
+static uint8_t const ktx2_identifier[12] = {
+    0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A
+};
+
+// Key-value entry holding frame delays, as little-endian int64 nanoseconds
+static char const delays_key[] = "SSSglFrameDelays";
+
+static uint32_t read_u32(uint8_t const* p)
+{
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8)
+        | (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+static uint64_t read_u64(uint8_t const* p)
+{
+    return static_cast<uint64_t>(read_u32(p)) | (static_cast<uint64_t>(read_u32(p + 4)) << 32);
+}
+
+static void write_u32(std::vector<uint8_t>& out, uint32_t value)
+{
+    for (int i = 0; i < 4; ++i)
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+}
+
+static void write_u64(std::vector<uint8_t>& out, uint64_t value)
+{
+    write_u32(out, static_cast<uint32_t>(value));
+    write_u32(out, static_cast<uint32_t>(value >> 32));
+}
+
+static void pad_to(std::vector<uint8_t>& out, size_t alignment)
+{
+    while (out.size() % alignment != 0)
+        out.push_back(0);
+}
+
+// Byte size of a single layer, 0 if the format isn't handled
+static size_t layer_size(GLenum format, unsigned int w, unsigned int h)
+{
+    if (format == GL_RGBA8)
+        return static_cast<size_t>(w) * static_cast<size_t>(h) * 4;
+    return static_cast<size_t>(Basic::Texture::compressedSize(format,
+        static_cast<int>(w), static_cast<int>(h)));
+}
+
+int load_ktx2(char const* filepath, KTX2Image& image)
+{
+    FILE* f;
+    errno_t err = fopen_s(&f, filepath, "rb");
+    if (err != 0) {
+        throw_exc(CONTEXT_MSG(getErrorString(err), filepath));
+    }
+    std::vector<uint8_t> file;
+    uint8_t buffer[4096];
+    size_t count;
+    while ((count = fread(buffer, 1, sizeof(buffer), f)) != 0)
+        file.insert(file.end(), buffer, buffer + count);
+    fclose(f);
+
+    // Header (48 bytes), index (32 bytes), and level 0 (24 bytes)
+    if (file.size() < 104 || std::memcmp(file.data(), ktx2_identifier, 12) != 0)
+        return -1;
+    uint8_t const* header = file.data() + 12;
+    uint32_t const vk_format = read_u32(header);
+    image.w = read_u32(header + 8);
+    image.h = read_u32(header + 12);
+    uint32_t const depth = read_u32(header + 16);
+    uint32_t const layer_count = std::max<uint32_t>(read_u32(header + 20), 1);
+    uint32_t const face_count = read_u32(header + 24);
+    uint32_t const supercompression = read_u32(header + 32);
+    if (depth > 1 || face_count != 1 || supercompression != 0)
+        return -1;
+
+    auto const it = std::find_if(std::cbegin(vk_formats), std::cend(vk_formats),
+        [&](auto const& pair) { return pair.first == vk_format; });
+    if (it == std::cend(vk_formats))
+        return -1;
+    image.format = it->second;
+
+    // Layers are contiguous in level 0
+    size_t const size = layer_size(image.format, image.w, image.h);
+    uint64_t const offset = read_u64(file.data() + 80);
+    uint64_t const length = read_u64(file.data() + 88);
+    if (offset > file.size() || length > file.size() - offset
+        || length < static_cast<uint64_t>(size) * layer_count)
+        return -1;
+    image.layers.resize(layer_count);
+    for (uint32_t i = 0; i < layer_count; ++i) {
+        uint8_t const* p = file.data() + offset + static_cast<size_t>(i) * size;
+        image.layers[i].assign(p, p + size);
+    }
+
+    // Look for frame delays in key-value data
+    image.delays.clear();
+    uint32_t const kvd_offset = read_u32(file.data() + 56);
+    uint32_t const kvd_length = read_u32(file.data() + 60);
+    if (static_cast<uint64_t>(kvd_offset) + kvd_length <= file.size()) {
+        size_t pos = kvd_offset;
+        size_t const end = static_cast<size_t>(kvd_offset) + kvd_length;
+        while (pos + 4 <= end) {
+            uint32_t const entry_size = read_u32(file.data() + pos);
+            uint8_t const* entry = file.data() + pos + 4;
+            if (pos + 4 + entry_size > end)
+                break;
+            size_t const value_size = entry_size - std::min<size_t>(entry_size, sizeof(delays_key));
+            if (std::memcmp(entry, delays_key, std::min<size_t>(entry_size, sizeof(delays_key))) == 0
+                && value_size == layer_count * sizeof(int64_t))
+            {
+                for (uint32_t i = 0; i < layer_count; ++i) {
+                    image.delays.push_back(static_cast<int64_t>(
+                        read_u64(entry + sizeof(delays_key) + i * sizeof(int64_t))));
+                }
+            }
+            pos += (4 + static_cast<size_t>(entry_size) + 3) & ~static_cast<size_t>(3);
+        }
+    }
+
+    return 1;
+}
+
+int save_ktx2(char const* filepath, KTX2Image const& image)
+{
+    // Data format descriptor: color model, texel block, and samples
+    // as (channel, bit offset, bit length, upper value)
+    uint32_t vk_format, color_model;
+    uint8_t block_dim, block_bytes;
+    std::vector<std::tuple<uint8_t, uint16_t, uint8_t, uint32_t>> samples;
+    switch (image.format) {
+    case GL_RGBA8:
+        vk_format = 37;
+        color_model = 1;    // RGBSDA
+        block_dim = 1;
+        block_bytes = 4;
+        samples = { { 0, 0, 8, 255 }, { 1, 8, 8, 255 }, { 2, 16, 8, 255 }, { 15, 24, 8, 255 } };
+        break;
+    case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+        vk_format = 137;
+        color_model = 130;  // BC3
+        block_dim = 4;
+        block_bytes = 16;
+        samples = { { 15, 0, 64, UINT32_MAX }, { 0, 64, 64, UINT32_MAX } };
+        break;
+    case GL_COMPRESSED_RGBA_BPTC_UNORM:
+        vk_format = 145;
+        color_model = 134;  // BC7
+        block_dim = 4;
+        block_bytes = 16;
+        samples = { { 0, 0, 128, UINT32_MAX } };
+        break;
+    default:
+        return -1;
+    }
+    size_t const size = layer_size(image.format, image.w, image.h);
+    for (auto const& layer : image.layers) {
+        if (layer.size() != size)
+            return -1;
+    }
+
+    std::vector<uint8_t> dfd;
+    uint32_t const block_size = 24 + 16 * static_cast<uint32_t>(samples.size());
+    write_u32(dfd, 4 + block_size);
+    write_u32(dfd, 0);                          // Khronos, basic descriptor
+    write_u32(dfd, 2 | (block_size << 16));     // Version 1.3
+    write_u32(dfd, color_model | (1 << 8) | (1 << 16)); // BT709, linear
+    uint32_t const dim = static_cast<uint32_t>(block_dim - 1);
+    write_u32(dfd, dim | (dim << 8));
+    write_u32(dfd, block_bytes);
+    write_u32(dfd, 0);
+    for (auto const& [channel, bit_offset, bit_length, upper] : samples) {
+        write_u32(dfd, bit_offset | (static_cast<uint32_t>(bit_length - 1) << 16)
+            | (static_cast<uint32_t>(channel) << 24));
+        write_u32(dfd, 0);
+        write_u32(dfd, 0);
+        write_u32(dfd, upper);
+    }
+
+    // Key-value data, sorted by key
+    std::vector<std::pair<std::string, std::vector<uint8_t>>> entries;
+    static char const writer[] = "SSS/GL";
+    entries.emplace_back("KTXwriter", std::vector<uint8_t>(writer, writer + sizeof(writer)));
+    if (!image.delays.empty()) {
+        std::vector<uint8_t> delays;
+        for (int64_t const delay : image.delays)
+            write_u64(delays, static_cast<uint64_t>(delay));
+        entries.emplace_back(delays_key, std::move(delays));
+    }
+    std::vector<uint8_t> kvd;
+    for (auto const& [key, value] : entries) {
+        write_u32(kvd, static_cast<uint32_t>(key.size() + 1 + value.size()));
+        kvd.insert(kvd.end(), key.cbegin(), key.cend());
+        kvd.push_back(0);
+        kvd.insert(kvd.end(), value.cbegin(), value.cend());
+        pad_to(kvd, 4);
+    }
+
+    uint32_t const layer_count = static_cast<uint32_t>(image.layers.size());
+    uint32_t const dfd_offset = 104;
+    uint32_t const kvd_offset = dfd_offset + static_cast<uint32_t>(dfd.size());
+    // Level data is aligned to lcm(texel block size, 4)
+    size_t const alignment = std::max<size_t>(block_bytes, 4);
+    uint64_t const level_offset = (kvd_offset + kvd.size() + alignment - 1) / alignment * alignment;
+    uint64_t const level_length = size * layer_count;
+
+    std::vector<uint8_t> out(ktx2_identifier, ktx2_identifier + 12);
+    write_u32(out, vk_format);
+    write_u32(out, 1);                          // typeSize
+    write_u32(out, image.w);
+    write_u32(out, image.h);
+    write_u32(out, 0);                          // pixelDepth
+    write_u32(out, layer_count > 1 ? layer_count : 0);
+    write_u32(out, 1);                          // faceCount
+    write_u32(out, 1);                          // levelCount
+    write_u32(out, 0);                          // supercompressionScheme
+    write_u32(out, dfd_offset);
+    write_u32(out, static_cast<uint32_t>(dfd.size()));
+    write_u32(out, kvd_offset);
+    write_u32(out, static_cast<uint32_t>(kvd.size()));
+    write_u64(out, 0);                          // sgdByteOffset
+    write_u64(out, 0);                          // sgdByteLength
+    write_u64(out, level_offset);
+    write_u64(out, level_length);
+    write_u64(out, level_length);
+    out.insert(out.end(), dfd.cbegin(), dfd.cend());
+    out.insert(out.end(), kvd.cbegin(), kvd.cend());
+    pad_to(out, alignment);
+    for (auto const& layer : image.layers)
+        out.insert(out.end(), layer.cbegin(), layer.cend());
+
+    FILE* f;
+    errno_t err = fopen_s(&f, filepath, "wb");
+    if (err != 0) {
+        throw_exc(CONTEXT_MSG(getErrorString(err), filepath));
+    }
+    size_t const written = fwrite(out.data(), 1, out.size(), f);
+    fclose(f);
+
+    return written == out.size() ? 1 : -1;
+}
+
+using Block = float[16][4];
+
+// Copies a 4x4 block, clamping coordinates on partial edge blocks
+static void fetch_block(uint8_t const* rgba, unsigned int w, unsigned int h,
+    unsigned int bx, unsigned int by, Block& px)
+{
+    for (unsigned int y = 0; y < 4; ++y) {
+        for (unsigned int x = 0; x < 4; ++x) {
+            unsigned int const sx = std::min(bx * 4 + x, w - 1);
+            unsigned int const sy = std::min(by * 4 + y, h - 1);
+            for (int c = 0; c < 4; ++c)
+                px[y * 4 + x][c] = static_cast<float>(rgba[(sy * w + sx) * 4 + c]);
+        }
+    }
+}
+
+// Fits the first N channels of given pixels on their principal axis,
+// and returns the extremities of the projected segment.
+template <int N>
+static void fit_endpoints(Block const& px, float (&e0)[4], float (&e1)[4])
+{
+    float mean[N]{};
+    for (int i = 0; i < 16; ++i) {
+        for (int c = 0; c < N; ++c)
+            mean[c] += px[i][c] / 16.f;
+    }
+    float cov[N][N]{};
+    for (int i = 0; i < 16; ++i) {
+        for (int a = 0; a < N; ++a) {
+            for (int b = 0; b < N; ++b)
+                cov[a][b] += (px[i][a] - mean[a]) * (px[i][b] - mean[b]);
+        }
+    }
+    // Power iteration, a few steps are enough for 16 points
+    float axis[N];
+    std::fill(std::begin(axis), std::end(axis), 1.f);
+    for (int iter = 0; iter < 8; ++iter) {
+        float next[N]{};
+        float norm = 0.f;
+        for (int a = 0; a < N; ++a) {
+            for (int b = 0; b < N; ++b)
+                next[a] += cov[a][b] * axis[b];
+            norm = std::max(norm, std::abs(next[a]));
+        }
+        // Uniform block
+        if (norm < 1e-6f)
+            break;
+        for (int a = 0; a < N; ++a)
+            axis[a] = next[a] / norm;
+    }
+    float length = 0.f;
+    for (int c = 0; c < N; ++c)
+        length += axis[c] * axis[c];
+    length = std::sqrt(length);
+    for (int c = 0; c < N; ++c)
+        axis[c] /= length;
+
+    float t_min = 0.f, t_max = 0.f;
+    for (int i = 0; i < 16; ++i) {
+        float t = 0.f;
+        for (int c = 0; c < N; ++c)
+            t += (px[i][c] - mean[c]) * axis[c];
+        t_min = std::min(t_min, t);
+        t_max = std::max(t_max, t);
+    }
+    for (int c = 0; c < N; ++c) {
+        e0[c] = std::clamp(mean[c] + axis[c] * t_max, 0.f, 255.f);
+        e1[c] = std::clamp(mean[c] + axis[c] * t_min, 0.f, 255.f);
+    }
+}
+
+// Returns the palette entry closest to given pixel
+template <int N, int Size>
+static uint32_t closest(float const (&pixel)[4], int const (&palette)[Size][4])
+{
+    uint32_t best = 0;
+    float best_error = FLT_MAX;
+    for (int i = 0; i < Size; ++i) {
+        float error = 0.f;
+        for (int c = 0; c < N; ++c) {
+            float const d = pixel[c] - static_cast<float>(palette[i][c]);
+            error += d * d;
+        }
+        if (error < best_error) {
+            best_error = error;
+            best = static_cast<uint32_t>(i);
+        }
+    }
+    return best;
+}
+
+static uint16_t pack_565(float const (&c)[4])
+{
+    uint16_t const r = static_cast<uint16_t>(std::lround(c[0] * 31.f / 255.f));
+    uint16_t const g = static_cast<uint16_t>(std::lround(c[1] * 63.f / 255.f));
+    uint16_t const b = static_cast<uint16_t>(std::lround(c[2] * 31.f / 255.f));
+    return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+static void unpack_565(uint16_t v, int (&c)[4])
+{
+    int const r = v >> 11, g = (v >> 5) & 63, b = v & 31;
+    c[0] = (r << 3) | (r >> 2);
+    c[1] = (g << 2) | (g >> 4);
+    c[2] = (b << 3) | (b >> 2);
+    c[3] = 255;
+}
+
+static void encode_bc3_block(Block const& px, uint8_t* out)
+{
+    // Alpha: 8 values interpolated between max (index 0) and min (index 1)
+    int a_max = 0, a_min = 255;
+    for (int i = 0; i < 16; ++i) {
+        a_max = std::max(a_max, static_cast<int>(px[i][3]));
+        a_min = std::min(a_min, static_cast<int>(px[i][3]));
+    }
+    out[0] = static_cast<uint8_t>(a_max);
+    out[1] = static_cast<uint8_t>(a_min);
+    uint64_t alpha_bits = 0;
+    if (a_max != a_min) {
+        // Steps from max to min, mapped to their palette index
+        static uint64_t const step_index[8] = { 0, 2, 3, 4, 5, 6, 7, 1 };
+        int const range = a_max - a_min;
+        for (int i = 0; i < 16; ++i) {
+            int const step = ((a_max - static_cast<int>(px[i][3])) * 7 + range / 2) / range;
+            alpha_bits |= step_index[step] << (3 * i);
+        }
+    }
+    for (int i = 0; i < 6; ++i)
+        out[2 + i] = static_cast<uint8_t>(alpha_bits >> (8 * i));
+
+    // Color: 4 colors, c0 > c1 selecting the opaque mode
+    float e0[4], e1[4];
+    fit_endpoints<3>(px, e0, e1);
+    uint16_t c0 = pack_565(e0), c1 = pack_565(e1);
+    if (c0 < c1)
+        std::swap(c0, c1);
+    uint32_t indices = 0;
+    if (c0 != c1) {
+        int palette[4][4];
+        unpack_565(c0, palette[0]);
+        unpack_565(c1, palette[1]);
+        for (int c = 0; c < 3; ++c) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        for (int i = 0; i < 16; ++i)
+            indices |= closest<3>(px[i], palette) << (2 * i);
+    }
+    out[8] = static_cast<uint8_t>(c0);
+    out[9] = static_cast<uint8_t>(c0 >> 8);
+    out[10] = static_cast<uint8_t>(c1);
+    out[11] = static_cast<uint8_t>(c1 >> 8);
+    for (int i = 0; i < 4; ++i)
+        out[12 + i] = static_cast<uint8_t>(indices >> (8 * i));
+}
+
+// Writes bits LSB first, as BC7 blocks are laid out
+struct BitWriter {
+    uint8_t* block;
+    unsigned int pos{ 0 };
+    void write(uint32_t value, unsigned int bits)
+    {
+        for (unsigned int i = 0; i < bits; ++i, ++pos) {
+            if ((value >> i) & 1)
+                block[pos >> 3] |= static_cast<uint8_t>(1 << (pos & 7));
+        }
+    }
+};
+
+// Mode 6 only: single subset, RGBA 7.7.7.7 endpoints with
+// a p-bit each, and 4-bit indices.
+static void encode_bc7_block(Block const& px, uint8_t* out)
+{
+    static int const weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    float e[2][4];
+    fit_endpoints<4>(px, e[0], e[1]);
+
+    // Quantize endpoints, keeping the p-bit with the least error
+    int q[2][4], p[2], endpoints[2][4];
+    for (int i = 0; i < 2; ++i) {
+        float best_error = FLT_MAX;
+        for (int bit = 0; bit < 2; ++bit) {
+            int candidate[4];
+            float error = 0.f;
+            for (int c = 0; c < 4; ++c) {
+                candidate[c] = std::clamp(static_cast<int>(std::lround((e[i][c] - bit) / 2.f)), 0, 127);
+                float const d = static_cast<float>((candidate[c] << 1) | bit) - e[i][c];
+                error += d * d;
+            }
+            if (error < best_error) {
+                best_error = error;
+                p[i] = bit;
+                std::copy(std::begin(candidate), std::end(candidate), q[i]);
+            }
+        }
+        for (int c = 0; c < 4; ++c)
+            endpoints[i][c] = (q[i][c] << 1) | p[i];
+    }
+
+    int palette[16][4];
+    for (int i = 0; i < 16; ++i) {
+        for (int c = 0; c < 4; ++c)
+            palette[i][c] = ((64 - weights[i]) * endpoints[0][c] + weights[i] * endpoints[1][c] + 32) >> 6;
+    }
+    uint32_t indices[16];
+    for (int i = 0; i < 16; ++i)
+        indices[i] = closest<4>(px[i], palette);
+
+    // The first index is stored without its top bit, which must be 0:
+    // swapping endpoints mirrors the (symmetric) palette.
+    if (indices[0] & 8) {
+        std::swap(q[0], q[1]);
+        std::swap(p[0], p[1]);
+        for (uint32_t& index : indices)
+            index = 15 - index;
+    }
+
+    std::memset(out, 0, 16);
+    BitWriter writer{ out };
+    writer.write(1 << 6, 7);
+    for (int c = 0; c < 4; ++c) {
+        writer.write(static_cast<uint32_t>(q[0][c]), 7);
+        writer.write(static_cast<uint32_t>(q[1][c]), 7);
+    }
+    writer.write(static_cast<uint32_t>(p[0]), 1);
+    writer.write(static_cast<uint32_t>(p[1]), 1);
+    writer.write(indices[0], 3);
+    for (int i = 1; i < 16; ++i)
+        writer.write(indices[i], 4);
+}
+
+template <void(*EncodeBlock)(Block const&, uint8_t*)>
+static void encode_blocks(uint8_t const* rgba, unsigned int w, unsigned int h, std::vector<uint8_t>& blocks)
+{
+    unsigned int const bw = (w + 3) / 4, bh = (h + 3) / 4;
+    blocks.assign(static_cast<size_t>(bw) * bh * 16, 0);
+    if (w == 0 || h == 0)
+        return;
+    Block px;
+    for (unsigned int by = 0; by < bh; ++by) {
+        for (unsigned int bx = 0; bx < bw; ++bx) {
+            fetch_block(rgba, w, h, bx, by, px);
+            EncodeBlock(px, &blocks[(static_cast<size_t>(by) * bw + bx) * 16]);
+        }
+    }
+}
+
+void encode_bc3(uint8_t const* rgba, unsigned int w, unsigned int h, std::vector<uint8_t>& blocks)
+{
+    encode_blocks<encode_bc3_block>(rgba, w, h, blocks);
+}
+
+void encode_bc7(uint8_t const* rgba, unsigned int w, unsigned int h, std::vector<uint8_t>& blocks)
+{
+    encode_blocks<encode_bc7_block>(rgba, w, h, blocks);
+}
+
+// Reads bits LSB first, as BC7 blocks are laid out
+struct BitReader {
+    uint8_t const* block;
+    unsigned int pos{ 0 };
+    uint32_t read(unsigned int bits)
+    {
+        uint32_t value = 0;
+        for (unsigned int i = 0; i < bits; ++i, ++pos)
+            value |= static_cast<uint32_t>((block[pos >> 3] >> (pos & 7)) & 1) << i;
+        return value;
+    }
+};
+
+// Alpha values of a 4x4 block, in pixel order
+using BlockAlpha = int[16];
+
+static int bc7_interpolate(int e0, int e1, uint32_t index, unsigned int index_bits)
+{
+    static int const weights2[4] = { 0, 21, 43, 64 };
+    static int const weights3[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+    static int const weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+    int const w = index_bits == 2 ? weights2[index] : index_bits == 3 ? weights3[index] : weights4[index];
+    return ((64 - w) * e0 + w * e1 + 32) >> 6;
+}
+
+// Expands an n-bit endpoint to 8 bits
+static int bc7_expand(uint32_t value, unsigned int bits)
+{
+    value <<= 8 - bits;
+    return static_cast<int>(value | (value >> bits));
+}
+
+// Subset of each pixel (bit i) for the 64 two-subset partitions
+static uint16_t const bc7_partitions2[64] = {
+    0xCCCC, 0x8888, 0xEEEE, 0xECC8, 0xC880, 0xFEEC, 0xFEC8, 0xEC80,
+    0xC800, 0xFFEC, 0xFE80, 0xE800, 0xFFE8, 0xFF00, 0xFFF0, 0xF000,
+    0xF710, 0x008E, 0x7100, 0x08CE, 0x008C, 0x7310, 0x3100, 0x8CCE,
+    0x088C, 0x3110, 0x6666, 0x366C, 0x17E8, 0x0FF0, 0x718E, 0x399C,
+    0xAAAA, 0xF0F0, 0x5A5A, 0x33CC, 0x3C3C, 0x55AA, 0x9696, 0xA55A,
+    0x73CE, 0x13C8, 0x324C, 0x3BDC, 0x6996, 0xC33C, 0x9966, 0x0660,
+    0x0272, 0x04E4, 0x4E40, 0x2720, 0xC936, 0x936C, 0x39C6, 0x639C,
+    0x9336, 0x9CC6, 0x817E, 0xE718, 0xCCF0, 0x0FCC, 0x7744, 0xEE22
+};
+// Anchor pixel of the second subset, whose index lacks its top bit
+static uint8_t const bc7_anchors2[64] = {
+    15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+    15,  2,  8,  2,  2,  8,  8, 15,  2,  8,  2,  2,  8,  8,  2,  2,
+    15, 15,  6,  8,  2,  8, 15, 15,  2,  8,  2,  2,  2, 15, 15,  6,
+     6,  2,  6,  8, 15, 15,  2,  2, 15, 15, 15, 15, 15,  2,  2, 15
+};
+
+// Decodes the alpha of a BC7 block. Modes 0 to 3 have no alpha.
+static void decode_bc7_alpha(uint8_t const* block, BlockAlpha& alpha)
+{
+    std::fill(std::begin(alpha), std::end(alpha), 255);
+    unsigned int mode = 0;
+    while (mode < 8 && !((block[0] >> mode) & 1))
+        ++mode;
+    BitReader reader{ block, mode + 1 };
+
+    if (mode == 4 || mode == 5) {
+        // Single subset, separate color & alpha indices, optional rotation
+        uint32_t const rotation = reader.read(2);
+        uint32_t const index_mode = mode == 4 ? reader.read(1) : 0;
+        unsigned int const color_bits = mode == 4 ? 5 : 7;
+        unsigned int const alpha_bits = mode == 4 ? 6 : 8;
+        int endpoints[4][2];
+        for (int c = 0; c < 3; ++c) {
+            for (int e = 0; e < 2; ++e)
+                endpoints[c][e] = bc7_expand(reader.read(color_bits), color_bits);
+        }
+        for (int e = 0; e < 2; ++e)
+            endpoints[3][e] = bc7_expand(reader.read(alpha_bits), alpha_bits);
+        // Primary (2-bit) then secondary indices, first ones lacking their top bit
+        unsigned int const secondary_bits = mode == 4 ? 3 : 2;
+        uint32_t primary[16], secondary[16];
+        for (int i = 0; i < 16; ++i)
+            primary[i] = reader.read(i == 0 ? 1 : 2);
+        for (int i = 0; i < 16; ++i)
+            secondary[i] = reader.read(i == 0 ? secondary_bits - 1 : secondary_bits);
+        // Channel ending up as alpha, and its indices
+        int const channel = rotation == 0 ? 3 : static_cast<int>(rotation) - 1;
+        bool const color_channel = rotation != 0;
+        bool const use_secondary = (index_mode == 0) != color_channel;
+        for (int i = 0; i < 16; ++i) {
+            alpha[i] = use_secondary
+                ? bc7_interpolate(endpoints[channel][0], endpoints[channel][1], secondary[i], secondary_bits)
+                : bc7_interpolate(endpoints[channel][0], endpoints[channel][1], primary[i], 2);
+        }
+    }
+    else if (mode == 6) {
+        // Single subset, RGBA 7.7.7.7 endpoints with a p-bit each
+        uint32_t endpoints[4][2];
+        for (int c = 0; c < 4; ++c) {
+            for (int e = 0; e < 2; ++e)
+                endpoints[c][e] = reader.read(7);
+        }
+        uint32_t const p0 = reader.read(1), p1 = reader.read(1);
+        int const a0 = static_cast<int>((endpoints[3][0] << 1) | p0);
+        int const a1 = static_cast<int>((endpoints[3][1] << 1) | p1);
+        for (int i = 0; i < 16; ++i)
+            alpha[i] = bc7_interpolate(a0, a1, reader.read(i == 0 ? 3 : 4), 4);
+    }
+    else if (mode == 7) {
+        // Two subsets, RGBA 5.5.5.5 endpoints with a p-bit each
+        uint32_t const partition = reader.read(6);
+        uint32_t endpoints[4][4];
+        for (int c = 0; c < 4; ++c) {
+            for (int e = 0; e < 4; ++e)
+                endpoints[c][e] = reader.read(5);
+        }
+        int a[4];
+        for (int e = 0; e < 4; ++e)
+            a[e] = bc7_expand((endpoints[3][e] << 1) | reader.read(1), 6);
+        for (int i = 0; i < 16; ++i) {
+            int const subset = (bc7_partitions2[partition] >> i) & 1;
+            bool const anchor = i == 0 || i == bc7_anchors2[partition];
+            alpha[i] = bc7_interpolate(a[subset * 2], a[subset * 2 + 1], reader.read(anchor ? 1 : 2), 2);
+        }
+    }
+    // Reserved mode 8 (no bit set) decodes as transparent black
+    else if (mode == 8) {
+        std::fill(std::begin(alpha), std::end(alpha), 0);
+    }
+}
+
+// Decodes the alpha of a BC3 block
+static void decode_bc3_alpha(uint8_t const* block, BlockAlpha& alpha)
+{
+    int const a0 = block[0], a1 = block[1];
+    int palette[8] = { a0, a1 };
+    if (a0 > a1) {
+        for (int i = 1; i < 7; ++i)
+            palette[i + 1] = ((7 - i) * a0 + i * a1) / 7;
+    }
+    else {
+        for (int i = 1; i < 5; ++i)
+            palette[i + 1] = ((5 - i) * a0 + i * a1) / 5;
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+    uint64_t bits = 0;
+    for (int i = 0; i < 6; ++i)
+        bits |= static_cast<uint64_t>(block[2 + i]) << (8 * i);
+    for (int i = 0; i < 16; ++i)
+        alpha[i] = palette[(bits >> (3 * i)) & 7];
+}
+
+// Decodes the alpha of a BC1 block, only transparent in its 3-color mode
+static void decode_bc1_alpha(uint8_t const* block, BlockAlpha& alpha)
+{
+    uint16_t const c0 = static_cast<uint16_t>(block[0] | (block[1] << 8));
+    uint16_t const c1 = static_cast<uint16_t>(block[2] | (block[3] << 8));
+    uint32_t const indices = block[4] | (block[5] << 8) | (block[6] << 16)
+        | (static_cast<uint32_t>(block[7]) << 24);
+    for (int i = 0; i < 16; ++i)
+        alpha[i] = c0 <= c1 && ((indices >> (2 * i)) & 3) == 3 ? 0 : 255;
+}
+
+bool decode_alpha_mask(GLenum format, uint8_t const* blocks, unsigned int w, unsigned int h,
+    std::vector<uint64_t>& mask)
+{
+    void (*decode)(uint8_t const*, BlockAlpha&) = nullptr;
+    size_t block_size = 16;
+    switch (format) {
+    case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+        decode = decode_bc1_alpha;
+        block_size = 8;
+        break;
+    case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+        decode = decode_bc3_alpha;
+        break;
+    case GL_COMPRESSED_RGBA_BPTC_UNORM:
+        decode = decode_bc7_alpha;
+        break;
+    default:
+        return false;
+    }
+
+    mask.assign((static_cast<size_t>(w) * h + 63) / 64, 0);
+    unsigned int const bw = (w + 3) / 4, bh = (h + 3) / 4;
+    BlockAlpha alpha;
+    for (unsigned int by = 0; by < bh; ++by) {
+        for (unsigned int bx = 0; bx < bw; ++bx) {
+            decode(blocks + (static_cast<size_t>(by) * bw + bx) * block_size, alpha);
+            for (unsigned int y = by * 4; y < std::min(by * 4 + 4, h); ++y) {
+                for (unsigned int x = bx * 4; x < std::min(bx * 4 + 4, w); ++x) {
+                    if (alpha[(y - by * 4) * 4 + (x - bx * 4)] == 0)
+                        continue;
+                    size_t const pixel = static_cast<size_t>(y) * w + x;
+                    mask[pixel / 64] |= uint64_t(1) << (pixel % 64);
+                }
+            }
+        }
+    }
+    return true;
+}
+
+INTERNAL_END;
+SSS_GL_END;
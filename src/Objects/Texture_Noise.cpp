@@ -0,0 +1,164 @@
+#include "GL/Objects/Texture.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define SSS_GL_SSE2
+#include <emmintrin.h>
+#endif
+
+SSS_GL_BEGIN;
+
+// Maps a -1/+1 noise value to a 0-255 index, truncated like static_cast
+static inline uint32_t noise_to_byte(float value) noexcept
+{
+    // NaN fails both comparisons and ends up as 0
+    float const v = (value * 0.5f + 0.5f) * 255.f;
+    return static_cast<uint32_t>(v > 0.f ? (v < 255.f ? v : 255.f) : 0.f);
+}
+
+static inline float noise_to_unit(float value) noexcept
+{
+    float const v = value * 0.5f + 0.5f;
+    return v > 0.f ? (v < 1.f ? v : 1.f) : 0.f;
+}
+
+// Each pass writes texels at or before the floats it reads, which is what
+// makes in place conversion safe. Vectorized loops load every float they
+// need before storing anything.
+static void convert_rgba8(float* data, size_t count, uint32_t const* ramp) noexcept
+{
+    uint32_t* out = reinterpret_cast<uint32_t*>(data);
+    size_t i = 0;
+#ifdef SSS_GL_SSE2
+    __m128 const half = _mm_set1_ps(0.5f);
+    __m128 const zero = _mm_setzero_ps();
+    __m128 const max = _mm_set1_ps(255.f);
+    __m128i const alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+    for (; i + 4 <= count; i += 4) {
+        __m128 v = _mm_loadu_ps(data + i);
+        v = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(v, half), half), max);
+        v = _mm_min_ps(_mm_max_ps(v, zero), max);
+        __m128i const gray = _mm_cvttps_epi32(v);
+        if (ramp != nullptr) {
+            alignas(16) uint32_t index[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(index), gray);
+            out[i]     = ramp[index[0]];
+            out[i + 1] = ramp[index[1]];
+            out[i + 2] = ramp[index[2]];
+            out[i + 3] = ramp[index[3]];
+        }
+        else {
+            // Same gray in R, G & B, opaque alpha
+            __m128i rgba = _mm_or_si128(gray, _mm_slli_epi32(gray, 8));
+            rgba = _mm_or_si128(rgba, _mm_slli_epi32(gray, 16));
+            rgba = _mm_or_si128(rgba, alpha);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), rgba);
+        }
+    }
+#endif
+    for (; i < count; ++i) {
+        uint32_t const gray = noise_to_byte(data[i]);
+        out[i] = ramp != nullptr ? ramp[gray] : (gray * 0x010101u) | 0xFF000000u;
+    }
+}
+
+static void convert_r8(float* data, size_t count) noexcept
+{
+    uint8_t* out = reinterpret_cast<uint8_t*>(data);
+    size_t i = 0;
+#ifdef SSS_GL_SSE2
+    __m128 const half = _mm_set1_ps(0.5f);
+    __m128 const zero = _mm_setzero_ps();
+    __m128 const max = _mm_set1_ps(255.f);
+    auto const convert = [&](float const* src) {
+        __m128 v = _mm_loadu_ps(src);
+        v = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(v, half), half), max);
+        return _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(v, zero), max));
+    };
+    for (; i + 16 <= count; i += 16) {
+        __m128i const a = convert(data + i);
+        __m128i const b = convert(data + i + 4);
+        __m128i const c = convert(data + i + 8);
+        __m128i const d = convert(data + i + 12);
+        __m128i const bytes = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), bytes);
+    }
+#endif
+    for (; i < count; ++i) {
+        out[i] = static_cast<uint8_t>(noise_to_byte(data[i]));
+    }
+}
+
+static void convert_r32f(float* data, size_t count) noexcept
+{
+    size_t i = 0;
+#ifdef SSS_GL_SSE2
+    __m128 const half = _mm_set1_ps(0.5f);
+    __m128 const zero = _mm_setzero_ps();
+    __m128 const one = _mm_set1_ps(1.f);
+    for (; i + 4 <= count; i += 4) {
+        __m128 v = _mm_loadu_ps(data + i);
+        v = _mm_add_ps(_mm_mul_ps(v, half), half);
+        _mm_storeu_ps(data + i, _mm_min_ps(_mm_max_ps(v, zero), one));
+    }
+#endif
+    for (; i < count; ++i) {
+        data[i] = noise_to_unit(data[i]);
+    }
+}
+
+void Texture::convertNoise(float* data, size_t count, GLenum format,
+    std::array<RGBA32, 256> const* ramp) noexcept
+{
+    // Texels are written over the floats they're converted from
+    static_assert(sizeof(RGBA32) == sizeof(float));
+    if (data == nullptr) {
+        return;
+    }
+    switch (format) {
+    case GL_R8:
+        convert_r8(data, count);
+        break;
+    case GL_R32F:
+        convert_r32f(data, count);
+        break;
+    default:
+        if (ramp != nullptr) {
+            uint32_t lut[256];
+            std::memcpy(lut, ramp->data(), sizeof(lut));
+            convert_rgba8(data, count, lut);
+        }
+        else
+            convert_rgba8(data, count, nullptr);
+        break;
+    }
+}
+
+std::array<RGBA32, 256> Texture::makeColorRamp(std::vector<glm::vec4> const& colors)
+{
+    std::array<RGBA32, 256> ramp;
+    if (colors.empty()) {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint8_t const v = static_cast<uint8_t>(i);
+            ramp[i] = RGBA32(v, v, v, 255);
+        }
+        return ramp;
+    }
+    auto const to_byte = [](float v) {
+        return static_cast<uint8_t>(std::lround(std::clamp(v, 0.f, 1.f) * 255.f));
+    };
+    float const last = static_cast<float>(colors.size() - 1);
+    for (uint32_t i = 0; i < 256; ++i) {
+        float const pos = static_cast<float>(i) / 255.f * last;
+        size_t const a = std::min(static_cast<size_t>(pos), colors.size() - 1);
+        size_t const b = std::min(a + 1, colors.size() - 1);
+        glm::vec4 const color = glm::mix(colors[a], colors[b], pos - static_cast<float>(a));
+        ramp[i] = RGBA32(to_byte(color.r), to_byte(color.g), to_byte(color.b), to_byte(color.a));
+    }
+    return ramp;
+}
+
+SSS_GL_END;
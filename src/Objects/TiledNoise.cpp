@@ -0,0 +1,222 @@
+#include "GL/Objects/TiledNoise.hpp"
+
+#include <algorithm>
+
+SSS_GL_BEGIN;
+
+// Rounds towards negative infinity, so that tiles don't overlap around 0
+static int floor_div(int a, int b) noexcept
+{
+    int const q = a / b;
+    return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+TiledNoise::TiledNoise(Noise::Params const& params, uint32_t tile_capacity)
+    : Texture(), _params(params), _tile_capacity(std::max<uint32_t>(tile_capacity, 1))
+{
+    _observe(_generating_thread);
+}
+
+TiledNoise::~TiledNoise() = default;
+
+TiledNoise::Shared TiledNoise::create(Noise::Params const& params, uint32_t tile_capacity)
+{
+    Shared ret(new TiledNoise(params, tile_capacity));
+    ret->_reset();
+    return ret;
+}
+
+void TiledNoise::setParams(Noise::Params const& params)
+{
+    if (_params == params) {
+        return;
+    }
+    _params = params;
+    _reset();
+    _generateMissing();
+}
+
+void TiledNoise::setVisibleArea(int x_min, int y_min, int x_max, int y_max)
+{
+    if (_params.width <= 0 || _params.height <= 0) {
+        return;
+    }
+    TileCoords const min = getTileCoords(x_min, y_min);
+    TileCoords const max = getTileCoords(std::max(x_min, x_max - 1), std::max(y_min, y_max - 1));
+
+    _visible.clear();
+    for (int y = min.second; y <= max.second; ++y) {
+        for (int x = min.first; x <= max.first; ++x) {
+            _visible.emplace_back(x, y);
+        }
+    }
+    // Closest tiles to the center are generated first
+    int const cx = min.first + max.first;
+    int const cy = min.second + max.second;
+    std::stable_sort(_visible.begin(), _visible.end(), [cx, cy](TileCoords const& a, TileCoords const& b) {
+        int const ax = 2 * a.first - cx, ay = 2 * a.second - cy;
+        int const bx = 2 * b.first - cx, by = 2 * b.second - cy;
+        return ax * ax + ay * ay < bx * bx + by * by;
+    });
+    if (_visible.size() > _tile_capacity) {
+        _visible.resize(_tile_capacity);
+    }
+
+    // Refresh LRU stamps of visible resident tiles
+    ++_visibility_stamp;
+    for (TileCoords const& tile : _visible) {
+        if (auto it = _resident.find(tile); it != _resident.end())
+            _last_visible[it->second] = _visibility_stamp;
+    }
+    _generateMissing();
+}
+
+TiledNoise::TileCoords TiledNoise::getTileCoords(int x, int y) const noexcept
+{
+    if (_params.width <= 0 || _params.height <= 0) {
+        return TileCoords(0, 0);
+    }
+    return TileCoords(floor_div(x, _params.width), floor_div(y, _params.height));
+}
+
+int TiledNoise::getTileLayer(int tile_x, int tile_y) const noexcept
+{
+    auto const it = _resident.find(TileCoords(tile_x, tile_y));
+    if (it == _resident.end()) {
+        return -1;
+    }
+    return static_cast<int>(it->second);
+}
+
+bool TiledNoise::isComplete() const noexcept
+{
+    return std::all_of(_visible.cbegin(), _visible.cend(), [this](TileCoords const& tile) {
+        return _resident.contains(tile);
+    });
+}
+
+void TiledNoise::_subjectUpdate(Subject const& subject, Event const& event)
+{
+    if (!subject.is<_AsyncGenerating>()) {
+        Texture::_subjectUpdate(subject, event);
+        return;
+    }
+
+    // Tiles of outdated parameters are dropped
+    bool uploaded = false;
+    if (_generating_thread._params == _params) {
+        for (auto& [tile, frame] : _generating_thread._generated) {
+            if (_isVisible(tile) && !_resident.contains(tile))
+                uploaded |= _upload(tile, std::move(frame));
+        }
+    }
+    _generating_thread._generated.clear();
+    if (uploaded) {
+        EMIT_EVENT("SSS_TEXTURE_CONTENT");
+    }
+
+    _generateMissing();
+}
+
+void TiledNoise::_reset()
+{
+    _resident.clear();
+    _slots.assign(_tile_capacity, TileCoords(0, 0));
+    _last_visible.assign(_tile_capacity, 0);
+    if (_params.width <= 0 || _params.height <= 0) {
+        _frames = Frame::Vector();
+        _internalEdit(Type::Raw);
+        return;
+    }
+
+    // One frame per layer, filled once tiles are generated
+    Frame::Vector frames(_tile_capacity);
+    frames.w = _params.width;
+    frames.h = _params.height;
+    frames.format = Noise::_format(_params);
+    frames.layers.resize(_tile_capacity);
+    for (uint32_t i = 0; i < _tile_capacity; ++i) {
+        frames[i].layer = i;
+        frames.layers[i] = i;
+    }
+    _frames = std::move(frames);
+    _internalEdit(Type::Raw);
+}
+
+void TiledNoise::_generateMissing()
+{
+    if (_generating_thread.isRunning()) {
+        return;
+    }
+    // Small batches, so that tiles show up progressively
+    static constexpr size_t batch_size = 4;
+    std::vector<TileCoords> missing;
+    for (TileCoords const& tile : _visible) {
+        if (!_resident.contains(tile)) {
+            missing.push_back(tile);
+            if (missing.size() == batch_size)
+                break;
+        }
+    }
+    if (!missing.empty()) {
+        _generating_thread.run(_params, missing);
+    }
+}
+
+bool TiledNoise::_upload(TileCoords const& tile, Frame&& frame)
+{
+    // Pick a free layer, or the least recently visible one
+    uint32_t layer = UINT32_MAX;
+    for (uint32_t i = 0; i < _tile_capacity; ++i) {
+        if (_last_visible[i] == 0) {
+            layer = i;
+            break;
+        }
+        if (_last_visible[i] == _visibility_stamp)
+            continue;
+        if (layer == UINT32_MAX || _last_visible[i] < _last_visible[layer])
+            layer = i;
+    }
+    if (layer == UINT32_MAX) {
+        return false;
+    }
+
+    if (_last_visible[layer] != 0)
+        _resident.erase(_slots[layer]);
+    _resident[tile] = layer;
+    _slots[layer] = tile;
+    _last_visible[layer] = _visibility_stamp;
+    Frame& target = _frames[layer];
+    target.pixels = std::move(frame.pixels);
+    target.blocks = std::move(frame.blocks);
+    target.alpha_mask.clear();
+    // Evicted layers are restored from _frames on the next bind()
+    if (!_raw_texture.isReleased()) {
+        void const* texels = target.blocks.empty()
+            ? static_cast<void const*>(target.pixels.data()) : target.blocks.data();
+        _raw_texture.editPixels(texels, layer);
+    }
+    return true;
+}
+
+bool TiledNoise::_isVisible(TileCoords const& tile) const noexcept
+{
+    return std::find(_visible.cbegin(), _visible.cend(), tile) != _visible.cend();
+}
+
+void TiledNoise::_AsyncGenerating::_asyncFunction(Noise::Params params, std::vector<TileCoords> tiles)
+{
+    _params = params;
+    _generated.clear();
+    // Tiles are flat, only their first slice is generated
+    Noise::Params flat = params;
+    flat.depth = 1;
+    for (TileCoords const& tile : tiles) {
+        if (_beingCanceled()) return;
+        Frame::Vector frames;
+        Noise::_generate(flat, frames, tile.first * params.width, tile.second * params.height);
+        _generated.emplace_back(tile, std::move(frames.front()));
+    }
+}
+
+SSS_GL_END;
@@ -1,6 +1,7 @@
 #include "GL/Window.hpp"
 #include "GL/Objects/Camera.hpp"
 #include "GL/Objects/Models/Plane.hpp"
+#include "GL/Objects/Noise.hpp"
 
 SSS_GL_BEGIN;
 
@@ -120,6 +121,28 @@ Window::Window(CreateArgs const& args) try
         glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &max_units);
         _main._max_glsl_tex_units = static_cast<uint32_t>(max_units);
 
+        // Retrieve supported compressed formats. GL_TEXTURE_COMPRESSED doesn't
+        // tell whether the driver decompresses on upload, which desktop drivers
+        // do for ETC2: it is only used when neither BPTC nor S3TC is available.
+        auto const is_supported = [](GLenum format) {
+            GLint supported = GL_FALSE, compressed = GL_FALSE;
+            glGetInternalformativ(GL_TEXTURE_2D_ARRAY, format, GL_INTERNALFORMAT_SUPPORTED, 1, &supported);
+            glGetInternalformativ(GL_TEXTURE_2D_ARRAY, format, GL_TEXTURE_COMPRESSED, 1, &compressed);
+            return supported == GL_TRUE && compressed == GL_TRUE;
+        };
+        for (GLenum const format : { GL_COMPRESSED_RGBA_BPTC_UNORM,
+            GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, GL_COMPRESSED_RGBA_S3TC_DXT1_EXT })
+        {
+            if (is_supported(format))
+                _main._compressed_formats.push_back(format);
+        }
+        if (_main._compressed_formats.empty()) {
+            for (GLenum const format : { GL_COMPRESSED_RGBA8_ETC2_EAC, GL_COMPRESSED_RGB8_ETC2 }) {
+                if (is_supported(format))
+                    _main._compressed_formats.push_back(format);
+            }
+        }
+
         _loadPresetShaders();
     }
     else {
@@ -138,6 +161,10 @@ CATCH_AND_RETHROW_METHOD_EXC;
 // Destructor
 Window::~Window()
 {
+    if (_picking.fbo != 0) {
+        Context const context = setContext();
+        _releasePicking();
+    }
     _renderers.clear();
     if (!_is_main) {
         if (_main._subs.count(_window.get()) != 0 && !_main._subs[_window.get()]) {
@@ -146,6 +173,8 @@ Window::~Window()
         _window.reset();
     }
     else {
+        // Cached GPU results need the context to be freed
+        Noise::clearCache();
         _main._preset_shaders.clear();
         _main._subs.clear();
         _window.reset();
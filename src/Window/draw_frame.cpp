@@ -1,5 +1,6 @@
 #include "GL/Window.hpp"
 #include "GL/Objects/Models/PlaneRenderer.hpp"
+#include <cstring>
 #include <filesystem>
 #include <ranges>
 
@@ -45,11 +46,6 @@ void Window::placeHoveredTextAreaCursor()
 
 void Window::_updateHoveredModel()
 {
-    // Reset hovering
-    _hovered.model.reset();
-    _hovered.camera.reset();
-    double z = DBL_MAX;
-
     // If the cursor is disabled (Camera mode), then its relative position is at
     // the center of the window, which, on -1/+1 coordinates, is 0/0.
     double x = 0., y = 0.;
@@ -64,6 +60,18 @@ void Window::_updateHoveredModel()
         y = ((y / h * 2.0) - 1.0) * -1.0;
     }
 
+    // The hovered model is updated once IDs are read back
+    if (_picking_mode == PickingMode::GPU) {
+        _requestPicking(x, y);
+        _hover_waiting_time = std::chrono::nanoseconds(0);
+        return;
+    }
+
+    // Reset hovering
+    _hovered.model.reset();
+    _hovered.camera.reset();
+    double z = DBL_MAX;
+
     // Loop over each renderer (in reverse order) and find their nearest
     // models at mouse coordinates
     for (auto const& renderer : _renderers | std::views::reverse) {
@@ -87,6 +95,12 @@ void Window::_updateHoveredModel()
                 break;
         }
     }
+    _logHoveredModel();
+    _hover_waiting_time = std::chrono::nanoseconds(0);
+}
+
+void Window::_logHoveredModel() const
+{
     if (Log::GL::Window::query(Log::GL::Window::get().hovered_model)) {
         auto const model = _hovered.model.lock();
         if (model) {
@@ -100,13 +114,155 @@ void Window::_updateHoveredModel()
             LOG_GL_MSG(buff);
         }
     }
-    _hover_waiting_time = std::chrono::nanoseconds(0);
+}
+
+void Window::setPickingMode(PickingMode mode)
+{
+    if (_picking_mode == mode) {
+        return;
+    }
+    _picking_mode = mode;
+    if (_picking_mode == PickingMode::CPU) {
+        Context const context = setContext();
+        _releasePicking();
+    }
+}
+
+void Window::_requestPicking(double x, double y)
+{
+    // A 1x1 framebuffer, only holding the pixel under the cursor
+    if (_picking.fbo == 0) {
+        glGenFramebuffers(1, &_picking.fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, _picking.fbo);
+        glGenRenderbuffers(1, &_picking.ids);
+        glBindRenderbuffer(GL_RENDERBUFFER, _picking.ids);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA32UI, 1, 1);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, _picking.ids);
+        glGenRenderbuffers(1, &_picking.depth);
+        glBindRenderbuffer(GL_RENDERBUFFER, _picking.depth);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, 1, 1);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, _picking.depth);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+        GLenum const status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        if (status != GL_FRAMEBUFFER_COMPLETE) {
+            _releasePicking();
+            throw_exc("Incomplete picking framebuffer.");
+        }
+        glGenBuffers(1, &_picking.pbo);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, _picking.pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, sizeof(glm::uvec4), nullptr, GL_STREAM_READ);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+
+    // Offset the viewport so that the cursor's pixel lands on the framebuffer
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    GLint const px = static_cast<GLint>((x + 1.0) / 2.0 * static_cast<double>(viewport[2]));
+    GLint const py = static_cast<GLint>((y + 1.0) / 2.0 * static_cast<double>(viewport[3]));
+    glBindFramebuffer(GL_FRAMEBUFFER, _picking.fbo);
+    glViewport(-px, -py, viewport[2], viewport[3]);
+    static constexpr GLuint no_id[4] = { 0, 0, 0, 0 };
+    glClearBufferuiv(GL_COLOR, 0, no_id);
+    glClear(GL_DEPTH_BUFFER_BIT);
+
+    // Draw every Plane::Renderer in order, depth testing does the rest
+    _picking.targets.clear();
+    _picking.cameras.clear();
+    for (auto const& renderer : _renderers) {
+        PlaneRenderer* plane_renderer = dynamic_cast<PlaneRenderer*>(renderer.get());
+        if (plane_renderer == nullptr || !plane_renderer->isActive())
+            continue;
+        plane_renderer->_renderPicking(_picking.targets);
+        _picking.cameras.resize(_picking.targets.size(), plane_renderer->camera);
+    }
+
+    // Asynchronous readback, a newer request replaces a pending one
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, _picking.pbo);
+    glReadPixels(0, 0, 1, 1, GL_RGBA_INTEGER, GL_UNSIGNED_INT, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (_picking.fence != nullptr) {
+        glDeleteSync(_picking.fence);
+    }
+    _picking.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+}
+
+void Window::_resolvePicking()
+{
+    if (_picking.fence == nullptr) {
+        return;
+    }
+    // Don't stall, check again next frame
+    if (glClientWaitSync(_picking.fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+        return;
+    }
+    glDeleteSync(_picking.fence);
+    _picking.fence = nullptr;
+
+    glm::uvec4 pixel(0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, _picking.pbo);
+    void const* data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, sizeof(pixel), GL_MAP_READ_BIT);
+    if (data != nullptr) {
+        std::memcpy(&pixel, data, sizeof(pixel));
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    _hovered.model.reset();
+    _hovered.camera.reset();
+    if (pixel.x != 0 && pixel.x <= _picking.targets.size()) {
+        auto const plane = _picking.targets[pixel.x - 1].lock();
+        if (plane) {
+            // Same relative coordinates as PlaneBase::_hoverTriangle
+            float const u = glm::uintBitsToFloat(pixel.y);
+            float const v = glm::uintBitsToFloat(pixel.z);
+            plane->_relative_x = static_cast<int>(u * static_cast<float>(plane->_tex_w));
+            plane->_relative_y = static_cast<int>(v * static_cast<float>(plane->_tex_h));
+            _hovered.model = plane;
+            _hovered.camera = _picking.cameras[pixel.x - 1];
+        }
+    }
+    _logHoveredModel();
+}
+
+void Window::_releasePicking()
+{
+    if (_picking.fence != nullptr) {
+        glDeleteSync(_picking.fence);
+        _picking.fence = nullptr;
+    }
+    if (_picking.pbo != 0) {
+        glDeleteBuffers(1, &_picking.pbo);
+        _picking.pbo = 0;
+    }
+    if (_picking.depth != 0) {
+        glDeleteRenderbuffers(1, &_picking.depth);
+        _picking.depth = 0;
+    }
+    if (_picking.ids != 0) {
+        glDeleteRenderbuffers(1, &_picking.ids);
+        _picking.ids = 0;
+    }
+    if (_picking.fbo != 0) {
+        glDeleteFramebuffers(1, &_picking.fbo);
+        _picking.fbo = 0;
+    }
+    _picking.targets.clear();
+    _picking.cameras.clear();
 }
 
 void Window::_updateHoveredModelIfNeeded(std::chrono::steady_clock::time_point const& now)
 {
     static constexpr std::chrono::milliseconds threshold(50);
 
+    // Pending picking pass (see PickingMode::GPU)
+    if (_picking_mode == PickingMode::GPU) {
+        _resolvePicking();
+    }
+
     // Bypass threshold if cursor just stopped moving
     if (_cursor_diff_x != 0 || _cursor_diff_y != 0) {
         _cursor_is_moving = true;
@@ -1,6 +1,8 @@
 #include "GL/Window.hpp"
 #include "GL/Objects/Texture.hpp"
+#include "GL/Objects/Noise.hpp"
 #include "GL/Objects/Models/Plane.hpp"
+#include "GL/Objects/Models/Line.hpp"
 
 SSS_GL_BEGIN;
 
@@ -84,6 +86,15 @@ void pollEverything() try
     // Poll threads
     pollAsync();
 
+    // Start coalesced Noise generations
+    Noise::_pollPending();
+
+    // Add lines meshed by Polyline::BatchAsync() to the batch
+    Polyline::_pollBatches();
+
+    // Flatten Bezier lines for the zoom of last frame's renderers
+    Polyline::_flattenBeziers();
+
     // Update every Text Area (this won't do anything if nothing is needed)
     TR::Area::updateAll();
 
@@ -92,14 +103,11 @@ void pollEverything() try
     for (auto& [ptr, win] : Window::_main._subs)
         win->_poll();
 
-    // Loop over each Plane instance
-    for (auto& ref : PlaneBase::_instances) {
-        PlaneBase& plane = ref.get();
-        if (plane.isPlaying()) {
-            plane._animation_duration += time_since_last_poll;
-            plane._updateTextureOffset();
-        }
-    }
+    // Advance playing animations
+    PlaneBase::_tickAnimations(time_since_last_poll);
+
+    // Free the GPU storage of unused textures exceeding the memory budget
+    Texture::_enforceBudget();
 
     last_poll = now;
 }
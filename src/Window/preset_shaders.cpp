@@ -6,7 +6,7 @@ SSS_GL_BEGIN;
 static void _planeShadersData(std::string& vertex, std::string& fragment)
 {
     vertex = R"(
-#version 330 core
+#version 430 core
 layout(location = 0) in vec3 a_Pos;
 layout(location = 1) in vec2 a_UV;
 
@@ -14,24 +14,71 @@ layout(location = 2) in mat4 a_Model;
 
 layout(location = 6) in float a_Alpha;
 layout(location = 7) in uint a_TextureOffset;
+// GPU animation: start time (ms), base time (ms, float bits), speed (float bits),
+// flags (bit 31: playing, bit 30: looping) | offset in u_Timings
+layout(location = 8) in uvec4 a_Animation;
+// Picking pass only: picking ID | hitbox << 30
+layout(location = 9) in uint a_Pick;
 
 uniform mat4 u_VP;
+// Milliseconds since the animation clock epoch
+uniform uint u_Time;
+
+// Per texture: frame count, total time, then (end time, layer) per frame
+layout(std430, binding = 1) readonly buffer AnimationTable {
+    float u_Timings[];
+};
 
 out vec3 UVW;
 out float Alpha;
 flat out int instanceID;
+flat out uint Pick;
+
+float animationLayer()
+{
+    uint offset = a_Animation.w & 0x3FFFFFFFu;
+    uint count = uint(u_Timings[offset]);
+    float total = u_Timings[offset + 1u];
+    if (count == 0u || total <= 0.0) {
+        return float(a_TextureOffset);
+    }
+    float t = uintBitsToFloat(a_Animation.y)
+        + float(u_Time - a_Animation.x) * uintBitsToFloat(a_Animation.z);
+    if ((a_Animation.w & 0x40000000u) != 0u) {
+        t = mod(t, total);
+    }
+    else if (t >= total) {
+        // Completed, back to the first frame like CPU animations
+        t = 0.0;
+    }
+    // Binary search of the first frame ending after t
+    uint lo = 0u;
+    uint hi = count - 1u;
+    while (lo < hi) {
+        uint mid = (lo + hi) / 2u;
+        if (u_Timings[offset + 2u + mid * 2u] > t) {
+            hi = mid;
+        }
+        else {
+            lo = mid + 1u;
+        }
+    }
+    return u_Timings[offset + 3u + lo * 2u];
+}
 
 void main()
 {
     gl_Position = u_VP * a_Model * vec4(a_Pos, 1);
-    UVW = vec3(a_UV, a_TextureOffset);
+    float layer = (a_Animation.w & 0x80000000u) != 0u ? animationLayer() : float(a_TextureOffset);
+    UVW = vec3(a_UV, layer);
     Alpha = a_Alpha;
     instanceID = gl_InstanceID;
+    Pick = a_Pick;
 }
 )";
 
     fragment = R"(
-#version 330 core
+#version 430 core
 out vec4 FragColor;
 
 in vec3 UVW;
@@ -63,6 +110,53 @@ void main()
 )";
 }
 
+// Plane shaders, writing picking IDs instead of colors
+static void _planePickingShadersData(std::string& vertex, std::string& fragment)
+{
+    _planeShadersData(vertex, fragment);
+
+    fragment = R"(
+#version 430 core
+// Picking ID, then relative UV (float bits)
+layout(location = 0) out uvec4 PickID;
+
+in vec3 UVW;
+flat in int instanceID;
+flat in uint Pick;
+
+uniform sampler2DArray u_Textures[gl_MaxTextureImageUnits];
+uniform int u_UVModes[gl_MaxTextureImageUnits];
+uniform vec2 u_UVOffsets[gl_MaxTextureImageUnits];
+
+#define _TWO_PI 6.28318530718
+
+void main()
+{
+    // Matches PlaneBase::Hitbox
+    uint hitbox = Pick >> 30u;
+    if (hitbox == 0u) {
+        discard;
+    }
+    // Alpha hitbox: same sampling as the Plane shader
+    if (hitbox == 1u) {
+        vec2 uv = UVW.xy;
+        if (u_UVModes[instanceID] == 1) {
+            vec2 c = uv - vec2(0.5);
+            float angle = atan(c.y, c.x) / _TWO_PI + 0.5 + u_UVOffsets[instanceID].x;
+            float radius = length(c) * 2.0 + u_UVOffsets[instanceID].y;
+            uv = vec2(angle, radius);
+        } else {
+            uv += u_UVOffsets[instanceID];
+        }
+        if (texture(u_Textures[instanceID], vec3(uv, UVW.z)).w == 0.0) {
+            discard;
+        }
+    }
+    PickID = uvec4(Pick & 0x3FFFFFFFu, floatBitsToUint(UVW.x), floatBitsToUint(UVW.y), 0u);
+}
+)";
+}
+
 static void _planeSDFShadersData(std::string& vertex, std::string& fragment)
 {
     vertex = R"(
@@ -622,6 +716,8 @@ static void _lineShadersData(std::string& vertex, std::string& fragment)
 //Coordinates and colors data input
 layout(location = 0) in vec3 vertexPosition_modelspace;
 layout(location = 1) in vec4 model_colors;
+//Line z of packed vertices, which only have xy coordinates
+layout(location = 2) in float line_z;
 
 //Color output for the fragment shader
 out vec4 fragmentColor;
@@ -632,7 +728,7 @@ uniform mat4 u_MVP;
 
 void main(){
     //Transform the vertex position using the ortho projection matrix
-    gl_Position =  u_MVP * vec4(vertexPosition_modelspace, 1);
+    gl_Position =  u_MVP * vec4(vertexPosition_modelspace.xy, vertexPosition_modelspace.z + line_z, 1);
 
     //Color output for the fragment shader
     fragmentColor = model_colors;
@@ -655,6 +751,203 @@ void main(){
 )";
 }
 
+static void _instancedLineShadersData(std::string& vertex, std::string& fragment)
+{
+    vertex = R"(
+#version 430 core
+
+struct Point {
+    // xyz & full thickness
+    vec4 position;
+    vec4 color;
+};
+
+layout(std430, binding = 0) readonly buffer Points {
+    Point points[];
+};
+
+// Previous, first, second & next point indices
+layout(location = 0) in uvec4 a_Points;
+// joint | term << 2 | has_previous << 4 | has_next << 5
+layout(location = 1) in uint a_Style;
+
+// Projection matrix
+uniform mat4 u_MVP;
+// Viewport size, in pixels
+uniform vec2 u_Viewport;
+
+out vec2 v_Pos;
+flat out vec2 v_A;
+flat out vec2 v_B;
+flat out vec2 v_Prev;
+flat out vec2 v_Next;
+flat out vec2 v_HalfWidth;
+flat out vec4 v_ColorA;
+flat out vec4 v_ColorB;
+flat out uint v_Style;
+
+// World units per pixel around p, along the most shrunk axis
+float pixelSize(vec3 p)
+{
+    vec4 clip = u_MVP * vec4(p, 1.0);
+    float w2 = max(clip.w * clip.w, 1e-12);
+    vec2 dx = (u_MVP[0].xy * clip.w - clip.xy * u_MVP[0].w) / w2;
+    vec2 dy = (u_MVP[1].xy * clip.w - clip.xy * u_MVP[1].w) / w2;
+    float pixels = min(length(dx * u_Viewport), length(dy * u_Viewport)) * 0.5;
+    return pixels > 1e-6 ? 1.0 / pixels : 0.0;
+}
+
+void main()
+{
+    Point a = points[a_Points.y];
+    Point b = points[a_Points.z];
+    v_Prev = points[a_Points.x].position.xy;
+    v_Next = points[a_Points.w].position.xy;
+    v_A = a.position.xy;
+    v_B = b.position.xy;
+    v_HalfWidth = vec2(a.position.w, b.position.w) * 0.5;
+    v_ColorA = a.color;
+    v_ColorB = b.color;
+    v_Style = a_Style;
+
+    vec2 ab = v_B - v_A;
+    float len = length(ab);
+    vec2 t = len > 1e-6 ? ab / len : vec2(1.0, 0.0);
+    vec2 n = vec2(-t.y, t.x);
+
+    // Quad covering the segment, its joints up to the miter limit,
+    // its caps and the anti-aliasing fringe, which spans pixels
+    float hw = max(v_HalfWidth.x, v_HalfWidth.y);
+    float px = max(pixelSize(a.position.xyz), pixelSize(b.position.xyz));
+    float margin = max(2.0, 2.0 * px);
+    float ext = hw * 2.5 + margin;
+    float side = hw + margin;
+    float u = (gl_VertexID & 1) == 0 ? -ext : len + ext;
+    float v = (gl_VertexID & 2) == 0 ? -side : side;
+
+    v_Pos = v_A + t * u + n * v;
+    float z = mix(a.position.z, b.position.z, len > 1e-6 ? clamp(u / len, 0.0, 1.0) : 0.0);
+    gl_Position = u_MVP * vec4(v_Pos, z, 1.0);
+}
+)";
+
+    fragment = R"(
+#version 430 core
+
+in vec2 v_Pos;
+flat in vec2 v_A;
+flat in vec2 v_B;
+flat in vec2 v_Prev;
+flat in vec2 v_Next;
+flat in vec2 v_HalfWidth;
+flat in vec4 v_ColorA;
+flat in vec4 v_ColorB;
+flat in uint v_Style;
+
+out vec4 FragColor;
+
+// Polyline::JointType
+const uint JOINT_ROUND = 0u;
+const uint JOINT_BEVEL = 1u;
+const uint JOINT_MITER = 2u;
+// Polyline::TermType
+const uint TERM_ROUND = 0u;
+const uint TERM_BUTT = 1u;
+const uint TERM_SQUARE = 2u;
+
+// Miters sharper than 45 degrees fall back to bevels
+const float MITER_LIMIT = -0.7071;
+
+vec2 direction(vec2 from, vec2 to, vec2 fallback)
+{
+    vec2 d = to - from;
+    float len = length(d);
+    return len > 1e-6 ? d / len : fallback;
+}
+
+float cross2(vec2 a, vec2 b)
+{
+    return a.x * b.y - a.y * b.x;
+}
+
+// Shapes the signed distance d around the joint p between t_in & t_out.
+// Each segment only draws its own side of the bisector, so that both
+// halves of the joint are blended once.
+float joint(float d, vec2 x, vec2 p, vec2 t_in, vec2 t_out, float hw, uint type, bool incoming)
+{
+    vec2 bisector = t_in + t_out;
+    bisector = dot(bisector, bisector) > 1e-8 ? normalize(bisector) : t_in;
+    float side = dot(x - p, bisector);
+    if (incoming ? side > 0.0 : side < 0.0)
+        discard;
+
+    // Distance past the joint, along this segment
+    float beyond = incoming ? dot(x - p, t_in) : -dot(x - p, t_out);
+    if (beyond <= 0.0)
+        return d;
+    if (type == JOINT_ROUND)
+        return length(x - p) - hw;
+    if (type == JOINT_MITER && dot(t_in, t_out) >= MITER_LIMIT)
+        return d;
+
+    // Bevel: cut the outer corner between both borders
+    vec2 n_in = vec2(-t_in.y, t_in.x);
+    vec2 n_out = vec2(-t_out.y, t_out.x);
+    vec2 n = n_in + n_out;
+    // Line folding back on itself
+    if (dot(n, n) < 1e-8)
+        return max(d, beyond);
+    n = normalize(n);
+    vec2 outer = -sign(cross2(t_in, t_out)) * n;
+    return max(d, dot(x - p, outer) - hw * abs(dot(n_in, n)));
+}
+
+float cap(float d, vec2 x, vec2 p, float beyond, float hw, uint type)
+{
+    if (type == TERM_ROUND)
+        return beyond > 0.0 ? length(x - p) - hw : d;
+    if (type == TERM_SQUARE)
+        return max(d, beyond - hw);
+    return max(d, beyond);
+}
+
+void main()
+{
+    vec2 x = v_Pos;
+    // Pixel footprint, computed before any discard
+    float aa = max(length(fwidth(x)) * 0.7071, 1e-4);
+
+    vec2 ab = v_B - v_A;
+    float len = length(ab);
+    vec2 t = len > 1e-6 ? ab / len : vec2(1.0, 0.0);
+    vec2 n = vec2(-t.y, t.x);
+    float u = dot(x - v_A, t);
+    float v = dot(x - v_A, n);
+    float k = len > 1e-6 ? clamp(u / len, 0.0, 1.0) : 0.0;
+
+    // Signed distance to the line border, negative inside
+    float d = abs(v) - mix(v_HalfWidth.x, v_HalfWidth.y, k);
+
+    uint joint_type = v_Style & 3u;
+    uint term_type = (v_Style >> 2u) & 3u;
+    if ((v_Style & 16u) != 0u)
+        d = joint(d, x, v_A, direction(v_Prev, v_A, t), t, v_HalfWidth.x, joint_type, false);
+    else
+        d = cap(d, x, v_A, -u, v_HalfWidth.x, term_type);
+    if ((v_Style & 32u) != 0u)
+        d = joint(d, x, v_B, t, direction(v_B, v_Next, t), v_HalfWidth.y, joint_type, true);
+    else
+        d = cap(d, x, v_B, u - len, v_HalfWidth.y, term_type);
+
+    float alpha = clamp(0.5 - d / aa, 0.0, 1.0);
+    if (alpha <= 0.0)
+        discard;
+    vec4 color = mix(v_ColorA, v_ColorB, k);
+    FragColor = vec4(color.rgb, color.a * alpha);
+}
+)";
+}
+
 static void _uiShapeShadersData(std::string& vertex, std::string& fragment)
 {
     vertex = R"(
@@ -998,6 +1291,290 @@ void main()
 )";
 }
 
+static void _noiseComputeShaderData(std::string& compute)
+{
+    compute = R"(
+#version 430 core
+
+layout(local_size_x = 16, local_size_y = 16) in;
+
+// Target layer of the Noise texture
+layout(rgba8, binding = 0) uniform writeonly image2DArray u_Output;
+
+// Noise::Type
+#define OPENSIMPLEX2        0
+#define OPENSIMPLEX2S       1
+#define PERLIN              2
+#define VALUE               3
+#define WHITE               4
+#define CELLULAR_VALUE      5
+#define CELLULAR_DISTANCE   6
+
+// Noise::CellularDistanceFunc
+#define EUCLIDEAN           0
+#define EUCLIDEAN_SQ        1
+#define MANHATTAN           2
+#define HYBRID              3
+#define MAX_AXIS            4
+
+// Noise::CellularReturnType
+#define INDEX0              0
+#define INDEX0_ADD1         1
+#define INDEX0_SUB1         2
+#define INDEX0_MUL1         3
+#define INDEX0_DIV1         4
+
+// Noise::DomainWarpType
+#define WARP_NONE           0
+
+// Noise::FractalType
+#define FRACTAL_NONE        0
+#define FRACTAL_FBM         1
+#define FRACTAL_RIDGED      2
+
+uniform ivec2 u_Size;
+uniform int   u_Layer;
+uniform float u_Z;
+uniform float u_ZStep;
+
+uniform int   u_Type;
+uniform float u_Frequency;
+uniform int   u_Seed;
+
+uniform int   u_CellDistFunc;
+uniform int   u_CellReturnType;
+uniform float u_CellGridJitter;
+uniform int   u_CellValueIndex;
+uniform int   u_CellDistIndex0;
+uniform int   u_CellDistIndex1;
+
+uniform int   u_WarpType;
+uniform float u_WarpAmplitude;
+uniform float u_WarpFrequency;
+
+uniform int   u_FractalType;
+uniform int   u_FractalOctaves;
+uniform float u_FractalLacunarity;
+uniform float u_FractalGain;
+
+const vec3 GRADIENTS[12] = vec3[12](
+    vec3( 1, 1, 0), vec3(-1, 1, 0), vec3( 1,-1, 0), vec3(-1,-1, 0),
+    vec3( 1, 0, 1), vec3(-1, 0, 1), vec3( 1, 0,-1), vec3(-1, 0,-1),
+    vec3( 0, 1, 1), vec3( 0,-1, 1), vec3( 0, 1,-1), vec3( 0,-1,-1)
+);
+
+uint hash(ivec3 c, int seed)
+{
+    uint h = uint(seed) * 0x27d4eb2du;
+    h ^= uint(c.x) * 0x8da6b343u;
+    h ^= uint(c.y) * 0xd8163841u;
+    h ^= uint(c.z) * 0xcb1ab31fu;
+    h ^= h >> 15;
+    h *= 0x2c1b3c6du;
+    h ^= h >> 12;
+    h *= 0x297a2d39u;
+    h ^= h >> 15;
+    return h;
+}
+
+// Hashed value in a -1/+1 range
+float hashValue(ivec3 c, int seed)
+{
+    return float(hash(c, seed)) * (2.0 / 4294967295.0) - 1.0;
+}
+
+float gradDot(ivec3 c, int seed, vec3 d)
+{
+    return dot(GRADIENTS[hash(c, seed) % 12u], d);
+}
+
+vec3 quintic(vec3 t)
+{
+    return t * t * t * (t * (t * 6.0 - 15.0) + 10.0);
+}
+
+float perlin(vec3 p, int seed)
+{
+    ivec3 i = ivec3(floor(p));
+    vec3 f = p - floor(p);
+    vec3 u = quintic(f);
+    float n000 = gradDot(i + ivec3(0, 0, 0), seed, f - vec3(0, 0, 0));
+    float n100 = gradDot(i + ivec3(1, 0, 0), seed, f - vec3(1, 0, 0));
+    float n010 = gradDot(i + ivec3(0, 1, 0), seed, f - vec3(0, 1, 0));
+    float n110 = gradDot(i + ivec3(1, 1, 0), seed, f - vec3(1, 1, 0));
+    float n001 = gradDot(i + ivec3(0, 0, 1), seed, f - vec3(0, 0, 1));
+    float n101 = gradDot(i + ivec3(1, 0, 1), seed, f - vec3(1, 0, 1));
+    float n011 = gradDot(i + ivec3(0, 1, 1), seed, f - vec3(0, 1, 1));
+    float n111 = gradDot(i + ivec3(1, 1, 1), seed, f - vec3(1, 1, 1));
+    return mix(mix(mix(n000, n100, u.x), mix(n010, n110, u.x), u.y),
+               mix(mix(n001, n101, u.x), mix(n011, n111, u.x), u.y), u.z);
+}
+
+float value(vec3 p, int seed)
+{
+    ivec3 i = ivec3(floor(p));
+    vec3 u = quintic(p - floor(p));
+    float n000 = hashValue(i + ivec3(0, 0, 0), seed);
+    float n100 = hashValue(i + ivec3(1, 0, 0), seed);
+    float n010 = hashValue(i + ivec3(0, 1, 0), seed);
+    float n110 = hashValue(i + ivec3(1, 1, 0), seed);
+    float n001 = hashValue(i + ivec3(0, 0, 1), seed);
+    float n101 = hashValue(i + ivec3(1, 0, 1), seed);
+    float n011 = hashValue(i + ivec3(0, 1, 1), seed);
+    float n111 = hashValue(i + ivec3(1, 1, 1), seed);
+    return mix(mix(mix(n000, n100, u.x), mix(n010, n110, u.x), u.y),
+               mix(mix(n001, n101, u.x), mix(n011, n111, u.x), u.y), u.z);
+}
+
+float simplexCorner(ivec3 c, int seed, vec3 d)
+{
+    float t = 0.6 - dot(d, d);
+    if (t <= 0.0)
+        return 0.0;
+    t *= t;
+    return t * t * gradDot(c, seed, d);
+}
+
+// Both OpenSimplex2 variants are approximated by classic simplex noise
+float simplex(vec3 p, int seed)
+{
+    const float F3 = 1.0 / 3.0;
+    const float G3 = 1.0 / 6.0;
+    vec3 s = floor(p + dot(p, vec3(F3)));
+    vec3 x0 = p - s + dot(s, vec3(G3));
+    vec3 g = step(x0.yzx, x0.xyz);
+    vec3 l = 1.0 - g;
+    vec3 i1 = min(g, l.zxy);
+    vec3 i2 = max(g, l.zxy);
+    ivec3 c = ivec3(s);
+    float n = simplexCorner(c, seed, x0)
+            + simplexCorner(c + ivec3(i1), seed, x0 - i1 + G3)
+            + simplexCorner(c + ivec3(i2), seed, x0 - i2 + 2.0 * G3)
+            + simplexCorner(c + ivec3(1), seed, x0 - 1.0 + 3.0 * G3);
+    return clamp(n * 32.0, -1.0, 1.0);
+}
+
+float white(vec3 p, int seed)
+{
+    return hashValue(floatBitsToInt(p), seed);
+}
+
+float cellDistance(vec3 d)
+{
+    switch (u_CellDistFunc) {
+    case EUCLIDEAN_SQ:  return dot(d, d);
+    case MANHATTAN:     return abs(d.x) + abs(d.y) + abs(d.z);
+    case HYBRID:        return dot(d, d) + abs(d.x) + abs(d.y) + abs(d.z);
+    case MAX_AXIS:      return max(max(abs(d.x), abs(d.y)), abs(d.z));
+    default:            return length(d);
+    }
+}
+
+float cellular(vec3 p, int seed)
+{
+    // Four closest feature points, sorted by distance
+    float dist[4] = float[4](1e10, 1e10, 1e10, 1e10);
+    float cell_value[4] = float[4](0.0, 0.0, 0.0, 0.0);
+    ivec3 base = ivec3(floor(p));
+    for (int z = -1; z <= 1; ++z) {
+        for (int y = -1; y <= 1; ++y) {
+            for (int x = -1; x <= 1; ++x) {
+                ivec3 c = base + ivec3(x, y, z);
+                vec3 jitter = vec3(hashValue(c, seed), hashValue(c, seed + 1), hashValue(c, seed + 2));
+                float d = cellDistance(vec3(c) + 0.5 + jitter * 0.5 * u_CellGridJitter - p);
+                float v = hashValue(c, seed + 3);
+                for (int k = 0; k < 4; ++k) {
+                    if (d < dist[k]) {
+                        for (int m = 3; m > k; --m) {
+                            dist[m] = dist[m - 1];
+                            cell_value[m] = cell_value[m - 1];
+                        }
+                        dist[k] = d;
+                        cell_value[k] = v;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    if (u_Type == CELLULAR_VALUE)
+        return cell_value[clamp(u_CellValueIndex, 0, 3)];
+
+    float d0 = dist[clamp(u_CellDistIndex0, 0, 3)];
+    float d1 = dist[clamp(u_CellDistIndex1, 0, 3)];
+    float r;
+    switch (u_CellReturnType) {
+    case INDEX0_ADD1:   r = d0 + d1; break;
+    case INDEX0_SUB1:   r = d0 - d1; break;
+    case INDEX0_MUL1:   r = d0 * d1; break;
+    case INDEX0_DIV1:   r = d0 / max(d1, 1e-6); break;
+    default:            r = d0; break;
+    }
+    return r * 2.0 - 1.0;
+}
+
+float baseNoise(vec3 p, int seed)
+{
+    switch (u_Type) {
+    case OPENSIMPLEX2:
+    case OPENSIMPLEX2S: return simplex(p, seed);
+    case PERLIN:        return perlin(p, seed);
+    case VALUE:         return value(p, seed);
+    case WHITE:         return white(p, seed);
+    default:            return cellular(p, seed);
+    }
+}
+
+float fractal(vec3 p)
+{
+    if (u_FractalType == FRACTAL_NONE)
+        return baseNoise(p, u_Seed);
+
+    int octaves = clamp(u_FractalOctaves, 1, 8);
+    float sum = 0.0;
+    float amplitude = 1.0;
+    float bounding = 0.0;
+    for (int i = 0; i < octaves; ++i) {
+        float n = baseNoise(p, u_Seed + i);
+        if (u_FractalType == FRACTAL_RIDGED)
+            n = 1.0 - 2.0 * abs(n);
+        sum += n * amplitude;
+        bounding += amplitude;
+        amplitude *= u_FractalGain;
+        p *= u_FractalLacunarity;
+    }
+    return sum / bounding;
+}
+
+// Gradient domain warp, offsets coordinates by three decorrelated Perlin noises
+vec3 warp(vec3 p)
+{
+    vec3 q = p * u_WarpFrequency;
+    vec3 offset = vec3(
+        perlin(q, u_Seed + 101),
+        perlin(q + vec3(19.1, 33.4, 47.2), u_Seed + 102),
+        perlin(q + vec3(74.2, 12.3, 5.7), u_Seed + 103)
+    );
+    return p + offset * u_WarpAmplitude;
+}
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+    if (any(greaterThanEqual(pixel, u_Size)))
+        return;
+
+    // One slice (and layer) per Z invocation
+    int slice = int(gl_GlobalInvocationID.z);
+    vec3 p = vec3(vec2(pixel) * u_Frequency, u_Z + float(slice) * u_ZStep);
+    if (u_WarpType != WARP_NONE)
+        p = warp(p);
+    float v = clamp(fractal(p) * 0.5 + 0.5, 0.0, 1.0);
+    imageStore(u_Output, ivec3(pixel, u_Layer + slice), vec4(v, v, v, 1.0));
+}
+)";
+}
+
 void Window::_loadPresetShaders() try
 {
     std::string vertex_data, fragment_data;
@@ -1050,6 +1627,34 @@ void Window::_loadPresetShaders() try
         shader->loadFromStrings(vertex_data, fragment_data);
     }
 
+    // Noise compute shader
+    {
+        uint32_t const id = static_cast<uint32_t>(Shaders::Preset::NoiseCompute);
+        auto& shader = _main._preset_shaders[id];
+        shader = Shaders::create();
+        std::string compute_data;
+        _noiseComputeShaderData(compute_data);
+        shader->loadComputeFromString(compute_data);
+    }
+
+    // Instanced line shader
+    {
+        uint32_t const id = static_cast<uint32_t>(Shaders::Preset::InstancedLine);
+        auto& shader = _main._preset_shaders[id];
+        shader = Shaders::create();
+        _instancedLineShadersData(vertex_data, fragment_data);
+        shader->loadFromStrings(vertex_data, fragment_data);
+    }
+
+    // Plane picking shader
+    {
+        uint32_t const id = static_cast<uint32_t>(Shaders::Preset::PlanePicking);
+        auto& shader = _main._preset_shaders[id];
+        shader = Shaders::create();
+        _planePickingShadersData(vertex_data, fragment_data);
+        shader->loadFromStrings(vertex_data, fragment_data);
+    }
+
 }
 CATCH_AND_RETHROW_FUNC_EXC;
 
@@ -0,0 +1,55 @@
+#include "GL.hpp"
+
+#include <iostream>
+
+/** @file
+ *  Offline converter from PNG (& APNG) or any stb_image format to
+ *  block-compressed KTX2 files, loadable via SSS::GL::Texture.
+ *
+ *  Usage: ktx2-convert <bc7|bc3> <input> [output]
+ *
+ *  When output is omitted, "name.png" is converted to "name.bc7.ktx2"
+ *  (or "name.bc3.ktx2"), which Texture::loadImage("name.png") picks up
+ *  when Texture::setCompressedVariants() is enabled.
+ */
+
+using namespace SSS;
+
+int main(int argc, char** argv)
+{
+    if (argc < 3) {
+        std::cerr << "Usage: ktx2-convert <bc7|bc3> <input> [output]" << std::endl;
+        return 1;
+    }
+
+    std::string const format(argv[1]);
+    GL::Texture::Compression compression;
+    if (format == "bc7")
+        compression = GL::Texture::Compression::BC7;
+    else if (format == "bc3")
+        compression = GL::Texture::Compression::BC3;
+    else {
+        std::cerr << "Unknown format: " << format << std::endl;
+        return 1;
+    }
+
+    std::string const input(argv[2]);
+    std::string output;
+    if (argc > 3)
+        output = argv[3];
+    else {
+        std::filesystem::path path(input);
+        path.replace_extension("." + format + ".ktx2");
+        output = path.string();
+    }
+
+    try {
+        GL::Texture::convertToKTX2(input, output, compression);
+    }
+    catch (std::exception const& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    std::cout << input << " -> " << output << std::endl;
+    return 0;
+}
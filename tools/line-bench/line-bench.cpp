@@ -0,0 +1,167 @@
+#include "GL.hpp"
+
+#include <iostream>
+#include <random>
+
+/** @file
+ *  Line rendering benchmark, meshing & drawing polylines with every
+ *  JointType & TermType combination in a hidden window.
+ *
+ *  Usage: line-bench [lines=1000] [points=64] [frames=120]
+ *
+ *  Results are printed to stdout as a single JSON object, with one entry
+ *  per combination:
+ *  - mesh_ms: creating every line one by one (Polyline::Line())
+ *  - batch_mesh_ms: creating every line at once (Polyline::Batch())
+ *  - first_frame_ms: first frame, uploading the whole batch
+ *  - frame_ms_mean & frame_ms_max: following frames
+ *  - vertices, triangles & upload_bytes: meshes of every line
+ *
+ *  GPU timings wait for glFinish(). Any OpenGL 4.3 driver works,
+ *  including software ones (e.g. Mesa llvmpipe) on headless machines.
+ */
+
+using namespace SSS;
+using Clock = std::chrono::steady_clock;
+
+static double elapsedMs(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Deterministic zigzags, spread over a 1280x720 view
+static std::vector<GL::Polyline::Vertex::Vec> generatePaths(size_t lines, size_t points)
+{
+    std::mt19937 rng(1337);
+    std::uniform_real_distribution<float> jitter(-20.f, 20.f);
+    std::vector<GL::Polyline::Vertex::Vec> paths(lines);
+    for (size_t l = 0; l < lines; ++l) {
+        float const y = -360.f + 720.f * (static_cast<float>(l) + 0.5f) / static_cast<float>(lines);
+        paths[l].reserve(points);
+        for (size_t p = 0; p < points; ++p) {
+            float const x = -640.f + 1280.f * static_cast<float>(p) / static_cast<float>(std::max<size_t>(points - 1, 1));
+            float const zigzag = (p % 2 == 0) ? 10.f : -10.f;
+            paths[l].emplace_back(glm::vec3(x, y + zigzag + jitter(rng), 0.f));
+        }
+    }
+    return paths;
+}
+
+int main(int argc, char** argv) try
+{
+    size_t const line_count = argc > 1 ? std::stoul(argv[1]) : 1000;
+    size_t const point_count = argc > 2 ? std::max<size_t>(std::stoul(argv[2]), 2) : 64;
+    size_t const frame_count = argc > 3 ? std::max<size_t>(std::stoul(argv[3]), 1) : 120;
+
+    GL::Window::CreateArgs args;
+    args.w = 1280;
+    args.h = 720;
+    args.title = "SSS/GL - Line benchmark";
+    args.hidden = true;
+    GL::Window& window = GL::Window::create(args);
+
+    auto camera = GL::Camera::create();
+    camera->setPosition(glm::vec3(0, 0, 3));
+    camera->setProjectionType(GL::Camera::Projection::OrthoFixed);
+
+    std::vector<GL::Polyline::Vertex::Vec> const paths = generatePaths(line_count, point_count);
+
+    static constexpr std::pair<GL::Polyline::JointType, char const*> joints[] = {
+        { GL::Polyline::JointType::ROUND, "ROUND" },
+        { GL::Polyline::JointType::BEVEL, "BEVEL" },
+        { GL::Polyline::JointType::MITER, "MITER" },
+    };
+    static constexpr std::pair<GL::Polyline::TermType, char const*> terms[] = {
+        { GL::Polyline::TermType::ROUND, "ROUND" },
+        { GL::Polyline::TermType::BUTT, "BUTT" },
+        { GL::Polyline::TermType::SQUARE, "SQUARE" },
+        { GL::Polyline::TermType::CONNECT, "CONNECT" },
+    };
+
+    std::cout << "{\"benchmark\":\"line-bench\",\"version\":1"
+        << ",\"gl_renderer\":\"" << reinterpret_cast<char const*>(glGetString(GL_RENDERER)) << "\""
+        << ",\"lines\":" << line_count
+        << ",\"points\":" << point_count
+        << ",\"frames\":" << frame_count
+        << ",\"results\":[";
+
+    bool first_result = true;
+    for (auto const& [jopt, joint_name] : joints) {
+        for (auto const& [topt, term_name] : terms) {
+            // Serial meshing
+            std::vector<GL::Polyline::Shared> lines;
+            lines.reserve(line_count);
+            Clock::time_point start = Clock::now();
+            for (GL::Polyline::Vertex::Vec const& path : paths) {
+                lines.push_back(GL::Polyline::Line(path, 10.f, glm::vec4(1, 1, 1, 1), jopt, topt));
+            }
+            double const mesh_ms = elapsedMs(start);
+            lines.clear();
+
+            // Parallel meshing
+            std::vector<GL::Polyline::Params> params(line_count);
+            for (size_t i = 0; i < line_count; ++i) {
+                params[i].path = paths[i];
+                params[i].thickness.push(std::make_pair(0.0f, 10.f));
+                params[i].color.push(std::make_pair(0.0f, glm::vec4(1, 1, 1, 1)));
+                params[i].jopt = jopt;
+                params[i].topt = topt;
+            }
+            start = Clock::now();
+            lines = GL::Polyline::Batch(std::move(params));
+            double const batch_mesh_ms = elapsedMs(start);
+
+            size_t vertices = 0, triangles = 0;
+            for (GL::Polyline::Shared const& line : lines) {
+                vertices += line->getVertexCount();
+                triangles += line->getTriangleCount();
+            }
+            size_t const upload_bytes = vertices * sizeof(GL::Polyline::Vertex)
+                + triangles * 3 * sizeof(uint32_t);
+
+            // A new renderer uploads the whole batch on its first frame
+            auto renderer = GL::LineRenderer::create();
+            renderer->camera = camera;
+            window.setRenderers({ renderer });
+
+            start = Clock::now();
+            window.drawObjects();
+            glFinish();
+            double const first_frame_ms = elapsedMs(start);
+
+            double frame_ms_total = 0.0, frame_ms_max = 0.0;
+            for (size_t i = 0; i < frame_count; ++i) {
+                start = Clock::now();
+                window.drawObjects();
+                glFinish();
+                double const frame_ms = elapsedMs(start);
+                frame_ms_total += frame_ms;
+                frame_ms_max = std::max(frame_ms_max, frame_ms);
+            }
+
+            std::cout << (first_result ? "" : ",")
+                << "{\"joint\":\"" << joint_name << "\""
+                << ",\"term\":\"" << term_name << "\""
+                << ",\"mesh_ms\":" << mesh_ms
+                << ",\"batch_mesh_ms\":" << batch_mesh_ms
+                << ",\"first_frame_ms\":" << first_frame_ms
+                << ",\"frame_ms_mean\":" << frame_ms_total / static_cast<double>(frame_count)
+                << ",\"frame_ms_max\":" << frame_ms_max
+                << ",\"vertices\":" << vertices
+                << ",\"triangles\":" << triangles
+                << ",\"upload_bytes\":" << upload_bytes
+                << "}";
+            first_result = false;
+
+            window.setRenderers({});
+        }
+    }
+    std::cout << "]}" << std::endl;
+
+    window.close();
+    return 0;
+}
+catch (std::exception const& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+}